@@ -7,16 +7,16 @@ in vec3 FragView;
 in vec3 Normal;
 in mat3 TBN;
 in float visibility;
-in vec4 FragPosLightSpace;
 
-uniform vec3 fogColor;
-uniform vec3 ambientLightColor;
-uniform sampler2D texture_diffuse;
-uniform sampler2D texture_specular;
-uniform sampler2D texture_emissive;
-uniform sampler2D texture_normal;
-uniform sampler2D shadowMap;
-uniform samplerCube depthMap;
+// Explicit locations, the variants compiled by ShaderVariantCache must match the default program
+layout (location = 210) uniform vec3 fogColor;
+layout (location = 211) uniform vec3 ambientLightColor;
+layout (location = 212) uniform sampler2D texture_diffuse;
+layout (location = 213) uniform sampler2D texture_specular;
+layout (location = 214) uniform sampler2D texture_emissive;
+layout (location = 215) uniform sampler2D texture_normal;
+layout (location = 216) uniform sampler2DArray shadowMap;
+layout (location = 217) uniform samplerCube depthMap;
 
 struct Material {
     vec3 baseColor;
@@ -50,10 +50,25 @@ struct PointLight {
     bool isTurnedOn;
 };
 
-uniform int pointLightsSize;
-uniform int directionalLightsSize;
-uniform bool calculatePointLightShadows;
-uniform float far_plane;
+layout (location = 218) uniform int directionalLightsSize;
+layout (location = 220) uniform float far_plane;
+
+const int MAX_CASCADES = 4;
+layout (location = 221) uniform mat4 lightSpaceMatrices[MAX_CASCADES];
+layout (location = 225) uniform float cascadeFarPlanes[MAX_CASCADES];
+layout (location = 229) uniform int cascadeCount;
+// World size of a texel of each cascade, in its light space depth
+layout (location = 233) uniform float cascadeTexelDepths[MAX_CASCADES];
+
+// Variants fold these switches into constants, the default program reads them from uniforms
+#if defined(SHADER_VARIANT)
+const bool calculatePointLightShadows = POINT_SHADOWS;
+const int shadowPcfRadius = PCF_RADIUS;
+#else
+layout (location = 219) uniform bool calculatePointLightShadows;
+// 0 = hard shadows, 1 = 3x3 PCF, 2 = 5x5 PCF
+layout (location = 230) uniform int shadowPcfRadius;
+#endif
 
 layout (std430, binding = 3) buffer pointLights
 {
@@ -65,28 +80,71 @@ layout (std430, binding = 4) buffer directionalLights
     DirectionalLight directionalLightsData[];
 };
 
-uniform Material material;
+// Clustered lighting, the grid must match ClusteredLights::GridX/GridY/GridZ
+const uvec3 CLUSTER_GRID = uvec3(16, 9, 24);
+layout (location = 202) uniform mat4 projection;
+layout (location = 231) uniform float clusterNear;
+layout (location = 232) uniform float clusterFar;
 
-float ShadowCalculation(vec4 fragPosLightSpace)
+layout (std430, binding = 5) buffer lightClusters
 {
+    uvec2 lightClustersData[];// (offset, count) in lightIndicesData
+};
+
+layout (std430, binding = 6) buffer lightIndices
+{
+    uint lightIndicesData[];
+};
+
+layout (location = 240) uniform Material material;
+
+float ShadowCalculation()
+{
+    // select the cascade from the view space depth
+    float depthValue = abs(FragView.z);
+    int layer = -1;
+    for (int i = 0; i < cascadeCount; i++)
+    {
+        if (depthValue < cascadeFarPlanes[i])
+        {
+            layer = i;
+            break;
+        }
+    }
+    if (layer == -1)
+        return 0.0;
+
+    vec4 fragPosLightSpace = lightSpaceMatrices[layer] * vec4(FragPos, 1.0);
     // perform perspective divide
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     // transform to [0,1] range
     projCoords = projCoords * 0.5 + 0.5;
-    // get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-    float closestDepth = texture(shadowMap, projCoords.xy).r;
     // get depth of current fragment from light's perspective
     float currentDepth = projCoords.z;
-    // calculate bias (based on depth and slope)
+    if (currentDepth > 1.0)
+        return 0.0;
+    // calculate bias (based on the slope) in texels of the cascade, farther cascades
+    // cover more space per texel and get a proportionally larger bias
     vec3 normal = normalize(Normal);
     vec3 lightDir = normalize(-directionalLightsData[0].direction);
-    float bias = max(0.05 * (1.0 - dot(normal, lightDir)), 0.005);
-    // check whether current frag pos is in shadow
+    float cosTheta = clamp(dot(normal, lightDir), 0.05, 1.0);
+    float slope = min(sqrt(1.0 - cosTheta * cosTheta) / cosTheta, 4.0);
+    float bias = (1.0 + slope) * cascadeTexelDepths[layer];
+
+    // check whether current frag pos is in shadow, averaging the neighbour texels when PCF is enabled
     float shadow = 0.0;
-    if(currentDepth - bias > closestDepth)
-        shadow = 1.0;
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0));
+    for (int x = -shadowPcfRadius; x <= shadowPcfRadius; x++)
+    {
+        for (int y = -shadowPcfRadius; y <= shadowPcfRadius; y++)
+        {
+            float closestDepth = texture(shadowMap, vec3(projCoords.xy + vec2(x, y) * texelSize, layer)).r;
+            shadow += currentDepth - bias > closestDepth ? 1.0 : 0.0;
+        }
+    }
+    float kernelSize = float(2 * shadowPcfRadius + 1);
 
-    return shadow;
+    return shadow / (kernelSize * kernelSize);
 }
 
 float ShadowCalculationPoint(PointLight light)
@@ -101,6 +159,19 @@ float ShadowCalculationPoint(PointLight light)
     return shadow;
 }
 
+uint GetClusterIndex()
+{
+    vec4 clipPos = projection * vec4(FragView, 1.0);
+    vec2 ndc = clipPos.xy / clipPos.w;
+    uvec2 tile = uvec2(clamp((ndc * 0.5 + 0.5) * vec2(CLUSTER_GRID.xy), vec2(0.0), vec2(CLUSTER_GRID.xy) - 1.0));
+
+    float depth = max(-FragView.z, clusterNear);
+    float slice = floor(log(depth / clusterNear) / log(clusterFar / clusterNear) * float(CLUSTER_GRID.z));
+    uint sliceIndex = uint(clamp(slice, 0.0, float(CLUSTER_GRID.z - 1u)));
+
+    return tile.x + CLUSTER_GRID.x * (tile.y + CLUSTER_GRID.y * sliceIndex);
+}
+
 vec4 CalcPointLight(PointLight light, vec3 normal)
 {
     float dist = length(light.position.xyz - FragPos);
@@ -141,7 +212,7 @@ vec4 CalcDirectionalLight(DirectionalLight light, vec3 normal)
     float spec = pow(max(dot(viewDir, reflectDir), 1.0f), material.shininess);
     vec3 specular = light.specular.rgb * spec * texture(texture_specular, uTexCoords).rgb;
 
-    float shadow = ShadowCalculation(FragPosLightSpace);
+    float shadow = ShadowCalculation();
     return vec4((ambient + (1.0 - shadow) * (diffuse + specular)), texture(texture_diffuse, uTexCoords).a);
 }
 
@@ -157,9 +228,10 @@ void main()
         totalColor += CalcDirectionalLight(directionalLightsData[i], normal);
     }
 
-    for (int i = 0; i < pointLightsSize; i++) {
-        if (!pointLightsData[i].isTurnedOn) continue;
-        totalColor += CalcPointLight(pointLightsData[i], normal);
+    // Only the lights that reach this cluster, the turned off ones are never assigned
+    uvec2 cluster = lightClustersData[GetClusterIndex()];
+    for (uint i = 0u; i < cluster.y; i++) {
+        totalColor += CalcPointLight(pointLightsData[lightIndicesData[cluster.x + i]], normal);
     }
 
     totalColor = mix(vec4(fogColor, 1.0f), totalColor, visibility);
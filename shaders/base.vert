@@ -14,26 +14,28 @@ out vec3 FragPos;
 out vec3 FragView;
 out mat3 TBN;
 out float visibility;
-out vec4 FragPosLightSpace;
 
 const int MAX_BONES = 200;
 const int MAX_BONE_INFLUENCE = 4;
 
-uniform mat4 bones[MAX_BONES];
-uniform int numBones;
-uniform mat4 view;
-uniform mat4 projection;
-uniform mat4 model;
-uniform mat4 lightSpaceMatrix;
-uniform float density = 0.025;
-uniform float gradient = 1.5;
+// Explicit locations, the variants compiled by ShaderVariantCache must match the default program
+layout (location = 0) uniform mat4 bones[MAX_BONES];
+layout (location = 200) uniform int numBones;
+layout (location = 201) uniform mat4 view;
+layout (location = 202) uniform mat4 projection;
+layout (location = 203) uniform mat4 model;
+layout (location = 204) uniform float density = 0.025;
+layout (location = 205) uniform float gradient = 1.5;
 
 void main() {
     uTexCoords = uv;
 
     mat4 boneTransform = mat4(1.0f);
+#if defined(SKINNED) || !defined(SHADER_VARIANT)
     mat4 totalBoneTransform = mat4(0.0f);
+#if !defined(SHADER_VARIANT)
     if (numBones > 0)
+#endif
     {
 
         for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
@@ -44,6 +46,7 @@ void main() {
         }
         boneTransform = totalBoneTransform;
     }
+#endif
 
     Normal = mat3(transpose(inverse(model * boneTransform))) * normal;
 
@@ -64,7 +67,5 @@ void main() {
     visibility = exp(-pow((distance * density), gradient));
     visibility = clamp(visibility, 0.0f, 1.0f);
 
-    FragPosLightSpace = lightSpaceMatrix * worldPos;
-
     gl_Position = projection * view * worldPos;
 }
\ No newline at end of file
@@ -1,9 +1,9 @@
 #version 430
 
-out vec4 FragColor;
+in vec3 Color;
 
-uniform vec3 color = vec3(1.0f, 1.0f, 1.0f);
+out vec4 FragColor;
 
 void main() {
-    FragColor = vec4(color, 1.0f);
+    FragColor = vec4(Color, 1.0f);
 }
\ No newline at end of file
@@ -1,11 +1,13 @@
 #version 430
 
 layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform mat4 viewProjection;
+
+out vec3 Color;
 
 void main() {
-    gl_Position = projection * view * model * vec4(aPos, 1.0f);
+    Color = aColor;
+    gl_Position = viewProjection * vec4(aPos, 1.0f);
 }
\ No newline at end of file
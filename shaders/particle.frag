@@ -0,0 +1,16 @@
+#version 430
+
+in vec2 TexCoords;
+in vec4 Color;
+
+uniform sampler2D particleTexture;
+
+out vec4 FragColor;
+
+void main()
+{
+    vec4 texel = texture(particleTexture, TexCoords);
+    FragColor = texel * Color;
+    if (FragColor.a < 0.01f)
+        discard;
+}
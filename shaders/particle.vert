@@ -0,0 +1,37 @@
+#version 430
+
+layout (location = 0) in vec2 aCorner;
+layout (location = 1) in vec4 aPositionSize;
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec4 aVelocityStretch;
+
+uniform mat4 viewProjection;
+uniform vec3 cameraPosition;
+
+out vec2 TexCoords;
+out vec4 Color;
+
+void main()
+{
+    vec3 center = aPositionSize.xyz;
+    vec3 toCamera = normalize(cameraPosition - center);
+    float speed = length(aVelocityStretch.xyz);
+
+    // Stretched particles are aligned with their velocity, the rest face the camera
+    vec3 right;
+    float width = aPositionSize.w;
+    if (aVelocityStretch.w > 0.0f && speed > 0.001f)
+    {
+        right = aVelocityStretch.xyz / speed;
+        width += aVelocityStretch.w * speed;
+    }
+    else
+        right = normalize(cross(vec3(0.0f, 1.0f, 0.0f), toCamera));
+    vec3 up = normalize(cross(toCamera, right));
+
+    vec3 position = center + right * aCorner.x * width + up * aCorner.y * aPositionSize.w;
+
+    TexCoords = aCorner + 0.5f;
+    Color = aColor;
+    gl_Position = viewProjection * vec4(position, 1.0f);
+}
@@ -0,0 +1,30 @@
+#ifndef PROYECTOFINAL_CGA_GAMECOMPONENTS_H
+#define PROYECTOFINAL_CGA_GAMECOMPONENTS_H
+
+#include "../Services/ComponentList.h"
+#include "BuildingComponent.h"
+#include "CoinComponent.h"
+#include "FloorComponent.h"
+#include "LodComponent.h"
+#include "ObstacleComponent.h"
+#include "ParentComponent.h"
+#include "ParticleEmitterComponent.h"
+#include "PathComponent.h"
+#include "RunnerComponent.h"
+#include "ECS/Components/AudioListener.h"
+#include "ECS/Components/AudioSource.h"
+#include "ECS/Components/Collider.h"
+#include "ECS/Components/MeshRenderer.h"
+#include "ECS/Components/Transform.h"
+
+/// Every component the game registers, the snapshots copy the same list.
+using GameComponents = ComponentList<ECS::Components::Transform, ECS::Components::MeshRenderer, ECS::Components::AABBCollider, ECS::Components::AudioSource,
+                                     ECS::Components::AudioListener, RunnerComponent, FloorComponent, PathComponent, ObstacleComponent, BuildingComponent,
+                                     CoinComponent, LodComponent, ParticleEmitterComponent, ParentComponent>;
+
+using GameSignatures = EntitySignatures<GameComponents>;
+
+template <typename... Args>
+using GameQuery = Query<GameComponents, Args...>;
+
+#endif // PROYECTOFINAL_CGA_GAMECOMPONENTS_H
@@ -0,0 +1,18 @@
+#ifndef PROYECTOFINAL_CGA_LODCOMPONENT_H
+#define PROYECTOFINAL_CGA_LODCOMPONENT_H
+
+#include <array>
+
+class Model;
+
+constexpr int MaxLodLevels = 3;
+
+struct LodComponent
+{
+    std::array<Model *, MaxLodLevels> levels{}; // levels[0] is the full detail model
+    int levelCount = 1;
+    float boundingRadius = 0.0f; // model space
+    int currentLevel = 0;
+};
+
+#endif // PROYECTOFINAL_CGA_LODCOMPONENT_H
@@ -0,0 +1,12 @@
+#ifndef PROYECTOFINAL_CGA_PARENTCOMPONENT_H
+#define PROYECTOFINAL_CGA_PARENTCOMPONENT_H
+
+#include "ECS/Entity.h"
+
+/// The entity's Transform is relative to the parent's world transform.
+struct ParentComponent
+{
+    ECS::Entity parent;
+};
+
+#endif // PROYECTOFINAL_CGA_PARENTCOMPONENT_H
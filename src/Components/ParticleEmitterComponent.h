@@ -0,0 +1,30 @@
+#ifndef PROYECTOFINAL_CGA_PARTICLEEMITTERCOMPONENT_H
+#define PROYECTOFINAL_CGA_PARTICLEEMITTERCOMPONENT_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+enum class ParticleEffect : std::uint8_t
+{
+    CoinSparkle,
+    ObstacleDebris,
+    SpeedLines,
+    Count
+};
+
+struct ParticleEmitterComponent
+{
+    ParticleEffect effect = ParticleEffect::CoinSparkle;
+    /// Particles emitted on the next update.
+    int burst = 0;
+    /// Particles per second while the emitter lives.
+    float rate = 0.0f;
+    /// Offset from the entity's translation.
+    glm::vec3 offset{0.0f};
+    /// One shot emitters destroy their entity once the burst is emitted.
+    bool oneShot = true;
+    float accumulator = 0.0f;
+};
+
+#endif // PROYECTOFINAL_CGA_PARTICLEEMITTERCOMPONENT_H
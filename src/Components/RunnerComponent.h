@@ -18,6 +18,9 @@ struct RunnerComponent
     int score = 0;
     int obstacleHits = 0;
     int nextExtraLife = 1000;
+    // Lane the runner moves to, -1, 0 or 1
+    int targetLane = 0;
+    bool downTriggered = false;
 };
 
 #endif // PROYECTOFINAL_CGA_RUNNERCOMPONENT_H
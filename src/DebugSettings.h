@@ -12,6 +12,11 @@ struct DebugSettings
     int pixelateResolution = 520;
     bool enableVsync = true;
     bool showHitboxes = false;
+    int shadowPcfRadius = 1;
+    bool enableDynamicResolution = false;
+    float targetFrameTime = 16.6f;
+    int dynamicResolutionMin = 256;
+    int dynamicResolutionMax = 1280;
 };
 
 inline void from_json(const nlohmann::json &j, DebugSettings &settings)
@@ -23,6 +28,11 @@ inline void from_json(const nlohmann::json &j, DebugSettings &settings)
     if (j.contains("pixelate_resolution")) j.at("pixelate_resolution").get_to(settings.pixelateResolution);
     if (j.contains("enable_vsync")) j.at("enable_vsync").get_to(settings.enableVsync);
     if (j.contains("show_hitboxes")) j.at("show_hitboxes").get_to(settings.showHitboxes);
+    if (j.contains("shadow_pcf_radius")) j.at("shadow_pcf_radius").get_to(settings.shadowPcfRadius);
+    if (j.contains("enable_dynamic_resolution")) j.at("enable_dynamic_resolution").get_to(settings.enableDynamicResolution);
+    if (j.contains("target_frame_time")) j.at("target_frame_time").get_to(settings.targetFrameTime);
+    if (j.contains("dynamic_resolution_min")) j.at("dynamic_resolution_min").get_to(settings.dynamicResolutionMin);
+    if (j.contains("dynamic_resolution_max")) j.at("dynamic_resolution_max").get_to(settings.dynamicResolutionMax);
 }
 
 inline void to_json(nlohmann::json &j, const DebugSettings &settings)
@@ -35,6 +45,11 @@ inline void to_json(nlohmann::json &j, const DebugSettings &settings)
         {"pixelate_resolution", settings.pixelateResolution},
         {"enable_vsync", settings.enableVsync},
         {"show_hitboxes", settings.showHitboxes},
+        {"shadow_pcf_radius", settings.shadowPcfRadius},
+        {"enable_dynamic_resolution", settings.enableDynamicResolution},
+        {"target_frame_time", settings.targetFrameTime},
+        {"dynamic_resolution_min", settings.dynamicResolutionMin},
+        {"dynamic_resolution_max", settings.dynamicResolutionMax},
     };
 }
 
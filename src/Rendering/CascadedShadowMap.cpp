@@ -0,0 +1,135 @@
+#include "GlobalDefines.h"
+
+#include "CascadedShadowMap.h"
+#include "ShadowCache.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+CascadedShadowMap::~CascadedShadowMap()
+{
+    if (fbo != 0) glDeleteFramebuffers(1, &fbo);
+    if (staticDepthArray != 0) glDeleteTextures(1, &staticDepthArray);
+    if (depthArray != 0) glDeleteTextures(1, &depthArray);
+}
+
+unsigned int CascadedShadowMap::CreateDepthArray(const int resolution, const int layers)
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT24, resolution, resolution, layers);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    constexpr float borderColor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, borderColor);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return texture;
+}
+
+void CascadedShadowMap::Init(const int cascadeResolution, const int cascades)
+{
+    resolution = cascadeResolution;
+    cascadeCount = std::clamp(cascades, 1, MaxCascades);
+
+    staticDepthArray = CreateDepthArray(resolution, cascadeCount);
+    depthArray = CreateDepthArray(resolution, cascadeCount);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthArray, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "\033[31mCascaded shadow map framebuffer is not complete!\033[0m\n";
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void CascadedShadowMap::Update(const glm::mat4 &view, const float fovY, const float aspect, const float nearPlane, const float shadowDistance, const glm::vec3 &lightDirection)
+{
+    const glm::vec3 lightDir = glm::normalize(lightDirection);
+    const glm::vec3 up = std::abs(glm::dot(lightDir, glm::vec3(0.0f, 1.0f, 0.0f))) > 0.99f
+                             ? glm::vec3(0.0f, 0.0f, 1.0f)
+                             : glm::vec3(0.0f, 1.0f, 0.0f);
+    const glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), lightDir, up);
+    const glm::mat4 inverseView = glm::inverse(view);
+
+    float sliceNear = nearPlane;
+    for (int cascade = 0; cascade < cascadeCount; cascade++)
+    {
+        // Practical split scheme, a blend between logarithmic and uniform splits
+        const float p = static_cast<float>(cascade + 1) / static_cast<float>(cascadeCount);
+        const float logSplit = nearPlane * std::pow(shadowDistance / nearPlane, p);
+        const float uniformSplit = nearPlane + (shadowDistance - nearPlane) * p;
+        const float sliceFar = splitLambda * logSplit + (1.0f - splitLambda) * uniformSplit;
+
+        const glm::mat4 inverseSlice = inverseView * glm::inverse(glm::perspective(fovY, aspect, sliceNear, sliceFar));
+        std::array<glm::vec3, 8> corners;
+        glm::vec3 center(0.0f);
+        for (int i = 0; i < 8; i++)
+        {
+            const glm::vec4 corner = inverseSlice * glm::vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 1.0f);
+            corners[i] = glm::vec3(corner) / corner.w;
+            center += corners[i];
+        }
+        center /= 8.0f;
+
+        // The sphere radius does not depend on the camera orientation, so the volume size never changes
+        float radius = 0.0f;
+        for (const auto &corner : corners)
+            radius = glm::max(radius, glm::length(corner - center));
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        // Snap the centre to the texel grid in light space
+        const float texelSize = (2.0f * radius) / static_cast<float>(resolution);
+        glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+        lightCenter.x = std::floor(lightCenter.x / texelSize) * texelSize;
+        lightCenter.y = std::floor(lightCenter.y / texelSize) * texelSize;
+
+        // Pull the near plane towards the light so casters outside the slice still cast into it
+        constexpr float casterMargin = 20.0f;
+        const glm::mat4 lightProjection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius,
+                                                     lightCenter.y - radius, lightCenter.y + radius,
+                                                     -(lightCenter.z + radius) - casterMargin, -(lightCenter.z - radius));
+
+        lightSpaceMatrices[cascade] = lightProjection * lightView;
+        cascadeFarPlanes[cascade] = sliceFar;
+        // The depth bias is measured in texels, the shader compares depths in [0, 1] of the near to far range
+        cascadeTexelDepths[cascade] = texelSize / (2.0f * radius + casterMargin);
+        sliceNear = sliceFar;
+    }
+}
+
+void CascadedShadowMap::BindLayer(const int cascade, const bool staticLayer, const bool clear) const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticLayer ? staticDepthArray : depthArray, 0, cascade);
+    glViewport(0, 0, resolution, resolution);
+    if (clear) glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void CascadedShadowMap::Unbind() { glBindFramebuffer(GL_FRAMEBUFFER, 0); }
+
+void CascadedShadowMap::CopyStaticLayers() const
+{
+    ShadowCache::CopyDepth(staticDepthArray, depthArray, GL_TEXTURE_2D_ARRAY, resolution, resolution, cascadeCount);
+}
+
+unsigned int CascadedShadowMap::GetDepthArray() const { return depthArray; }
+
+int CascadedShadowMap::GetCascadeCount() const { return cascadeCount; }
+
+int CascadedShadowMap::GetResolution() const { return resolution; }
+
+const glm::mat4 &CascadedShadowMap::GetLightSpaceMatrix(const int cascade) const { return lightSpaceMatrices[cascade]; }
+
+float CascadedShadowMap::GetCascadeFarPlane(const int cascade) const { return cascadeFarPlanes[cascade]; }
+
+float CascadedShadowMap::GetCascadeTexelDepth(const int cascade) const { return cascadeTexelDepths[cascade]; }
+
+void CascadedShadowMap::SetSplitLambda(const float lambda) { splitLambda = lambda; }
@@ -0,0 +1,76 @@
+#ifndef PROYECTOFINAL_CGA_CASCADEDSHADOWMAP_H
+#define PROYECTOFINAL_CGA_CASCADEDSHADOWMAP_H
+
+#include <glm/glm.hpp>
+
+#include <array>
+
+/**
+ * Directional light shadow map split in cascades fitted to the camera frustum.
+ *
+ * Every cascade is a layer of a depth texture array. A second array keeps the
+ * static casters so the final one can be recomposed without drawing the whole
+ * scene again (see ShadowCache).
+ */
+class CascadedShadowMap
+{
+  public:
+    static constexpr int MaxCascades = 4;
+
+  private:
+    unsigned int fbo = 0;
+    unsigned int staticDepthArray = 0;
+    unsigned int depthArray = 0;
+    int resolution = 0;
+    int cascadeCount = 0;
+    float splitLambda = 0.75f;
+
+    std::array<glm::mat4, MaxCascades> lightSpaceMatrices{};
+    std::array<float, MaxCascades> cascadeFarPlanes{};
+    std::array<float, MaxCascades> cascadeTexelDepths{};
+
+    static unsigned int CreateDepthArray(int resolution, int layers);
+
+  public:
+    CascadedShadowMap() = default;
+
+    CascadedShadowMap(const CascadedShadowMap &) = delete;
+
+    CascadedShadowMap &operator=(const CascadedShadowMap &) = delete;
+
+    ~CascadedShadowMap();
+
+    void Init(int cascadeResolution, int cascades);
+
+    /**
+     * Fits one orthographic light volume around each slice of the camera frustum.
+     * The volumes are bounding spheres snapped to whole texels so the shadows do
+     * not shimmer while the camera or the world moves.
+     */
+    void Update(const glm::mat4 &view, float fovY, float aspect, float nearPlane, float shadowDistance, const glm::vec3 &lightDirection);
+
+    /// Binds the given cascade of the static (or final) array as the depth target and clears it when requested.
+    void BindLayer(int cascade, bool staticLayer, bool clear = true) const;
+
+    static void Unbind();
+
+    /// Copies all the static cascades into the final array.
+    void CopyStaticLayers() const;
+
+    [[nodiscard]] unsigned int GetDepthArray() const;
+
+    [[nodiscard]] int GetCascadeCount() const;
+
+    [[nodiscard]] int GetResolution() const;
+
+    [[nodiscard]] const glm::mat4 &GetLightSpaceMatrix(int cascade) const;
+
+    [[nodiscard]] float GetCascadeFarPlane(int cascade) const;
+
+    /// World size of one texel of the cascade (its extent over the resolution), in the [0, 1] depth of its light volume.
+    [[nodiscard]] float GetCascadeTexelDepth(int cascade) const;
+
+    void SetSplitLambda(float lambda);
+};
+
+#endif // PROYECTOFINAL_CGA_CASCADEDSHADOWMAP_H
@@ -0,0 +1,195 @@
+#include "GlobalDefines.h"
+
+#include "ClusteredLights.h"
+
+#include <algorithm>
+#include <cmath>
+
+ClusteredLights::ClusteredLights(const unsigned int gridBindingPoint, const unsigned int indexBindingPoint) :
+    gridBinding(gridBindingPoint),
+    indexBinding(indexBindingPoint)
+{
+}
+
+ClusteredLights::~ClusteredLights()
+{
+    if (gridBuffer != 0) glDeleteBuffers(1, &gridBuffer);
+    if (indexBuffer != 0) glDeleteBuffers(1, &indexBuffer);
+}
+
+void ClusteredLights::Init()
+{
+    minX.resize(ClusterCount);
+    minY.resize(ClusterCount);
+    minZ.resize(ClusterCount);
+    maxX.resize(ClusterCount);
+    maxY.resize(ClusterCount);
+    maxZ.resize(ClusterCount);
+    overlap.resize(ClusterCount);
+    clusterCounts.resize(ClusterCount);
+    clusterData.resize(ClusterCount * 2);
+
+    glGenBuffers(1, &gridBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, gridBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(clusterData.size() * sizeof(std::uint32_t)), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, gridBinding, gridBuffer);
+
+    // Never bind an empty buffer, the shader may read index 0 of an empty cluster list
+    indexBufferCapacity = 1024;
+    glGenBuffers(1, &indexBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, indexBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(indexBufferCapacity * sizeof(std::uint32_t)), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, indexBinding, indexBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+std::uint32_t ClusteredLights::SliceFromDepth(const float depth) const
+{
+    if (depth <= nearPlane) return 0;
+    const float slice = std::log(depth / nearPlane) / std::log(farPlane / nearPlane) * static_cast<float>(GridZ);
+    return std::min(static_cast<std::uint32_t>(slice), GridZ - 1);
+}
+
+void ClusteredLights::BuildClusterBounds(const glm::mat4 &projection)
+{
+    // For a symmetric perspective a point at depth d with NDC (u, v) is at (u * d / P00, v * d / P11, -d)
+    const float invP00 = 1.0f / projection[0][0];
+    const float invP11 = 1.0f / projection[1][1];
+
+    for (std::uint32_t z = 0; z < GridZ; z++)
+    {
+        const float sliceNear = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z) / static_cast<float>(GridZ));
+        const float sliceFar = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z + 1) / static_cast<float>(GridZ));
+
+        for (std::uint32_t y = 0; y < GridY; y++)
+        {
+            const float v0 = (static_cast<float>(y) / static_cast<float>(GridY)) * 2.0f - 1.0f;
+            const float v1 = (static_cast<float>(y + 1) / static_cast<float>(GridY)) * 2.0f - 1.0f;
+
+            for (std::uint32_t x = 0; x < GridX; x++)
+            {
+                const float u0 = (static_cast<float>(x) / static_cast<float>(GridX)) * 2.0f - 1.0f;
+                const float u1 = (static_cast<float>(x + 1) / static_cast<float>(GridX)) * 2.0f - 1.0f;
+
+                const std::uint32_t cluster = x + GridX * (y + GridY * z);
+                minX[cluster] = std::min({u0 * sliceNear, u0 * sliceFar}) * invP00;
+                maxX[cluster] = std::max({u1 * sliceNear, u1 * sliceFar}) * invP00;
+                minY[cluster] = std::min({v0 * sliceNear, v0 * sliceFar}) * invP11;
+                maxY[cluster] = std::max({v1 * sliceNear, v1 * sliceFar}) * invP11;
+                minZ[cluster] = -sliceFar;
+                maxZ[cluster] = -sliceNear;
+            }
+        }
+    }
+}
+
+void ClusteredLights::Begin(const glm::mat4 &projection, const float near, const float far)
+{
+    if (projection != lastProjection || near != nearPlane || far != farPlane)
+    {
+        nearPlane = near;
+        farPlane = far;
+        lastProjection = projection;
+        BuildClusterBounds(projection);
+    }
+
+    pairs.clear();
+    activeLights = 0;
+}
+
+float ClusteredLights::LightRadius(const Lights::PointLight &light, const float maxRadius)
+{
+    // Solve intensity / (c + l*d + q*d²) = threshold for d
+    constexpr float threshold = 2.0f / 256.0f;
+    const float intensity = std::max({light.diffuse.x, light.diffuse.y, light.diffuse.z, light.ambient.x, light.ambient.y, light.ambient.z});
+    const float c = light.constant - intensity / threshold;
+
+    if (light.quadratic > 0.0f)
+    {
+        const float discriminant = light.linear * light.linear - 4.0f * light.quadratic * c;
+        return std::min((-light.linear + std::sqrt(std::max(discriminant, 0.0f))) / (2.0f * light.quadratic), maxRadius);
+    }
+    if (light.linear > 0.0f)
+        return std::min(-c / light.linear, maxRadius);
+
+    return maxRadius;
+}
+
+void ClusteredLights::AddLight(const glm::mat4 &view, const Lights::PointLight &light, const std::uint32_t index)
+{
+    if (!light.isTurnedOn) return;
+
+    const float radius = LightRadius(light, farPlane);
+    const glm::vec3 center = glm::vec3(view * glm::vec4(glm::vec3(light.position), 1.0f));
+    const float depth = -center.z;
+    if (depth + radius < nearPlane || depth - radius > farPlane) return;
+
+    activeLights++;
+    const std::uint32_t firstSlice = SliceFromDepth(depth - radius);
+    const std::uint32_t lastSlice = SliceFromDepth(depth + radius);
+    const float radiusSquared = radius * radius;
+
+    const std::uint32_t first = firstSlice * GridX * GridY;
+    const std::uint32_t last = (lastSlice + 1) * GridX * GridY;
+
+    // Sphere against the cluster AABBs, branch free over the SoA bounds so the compiler can vectorize it
+    std::uint8_t *overlaps = overlap.data();
+    for (std::uint32_t cluster = first; cluster < last; cluster++)
+    {
+        const float dx = std::max(std::max(minX[cluster] - center.x, center.x - maxX[cluster]), 0.0f);
+        const float dy = std::max(std::max(minY[cluster] - center.y, center.y - maxY[cluster]), 0.0f);
+        const float dz = std::max(std::max(minZ[cluster] - center.z, center.z - maxZ[cluster]), 0.0f);
+        overlaps[cluster] = static_cast<std::uint8_t>(dx * dx + dy * dy + dz * dz <= radiusSquared);
+    }
+
+    for (std::uint32_t cluster = first; cluster < last; cluster++)
+    {
+        if (!overlaps[cluster]) continue;
+        pairs.push_back(cluster);
+        pairs.push_back(index);
+    }
+}
+
+void ClusteredLights::Upload()
+{
+    std::ranges::fill(clusterCounts, 0u);
+    for (std::size_t i = 0; i < pairs.size(); i += 2)
+        clusterCounts[pairs[i]]++;
+
+    std::uint32_t offset = 0;
+    for (std::uint32_t cluster = 0; cluster < ClusterCount; cluster++)
+    {
+        clusterData[cluster * 2] = offset;
+        clusterData[cluster * 2 + 1] = 0;
+        offset += clusterCounts[cluster];
+    }
+
+    lightIndices.resize(std::max<std::size_t>(offset, 1));
+    for (std::size_t i = 0; i < pairs.size(); i += 2)
+    {
+        const std::uint32_t cluster = pairs[i];
+        lightIndices[clusterData[cluster * 2] + clusterData[cluster * 2 + 1]++] = pairs[i + 1];
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, gridBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(clusterData.size() * sizeof(std::uint32_t)), clusterData.data());
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, indexBuffer);
+    if (lightIndices.size() > indexBufferCapacity)
+    {
+        while (indexBufferCapacity < lightIndices.size())
+            indexBufferCapacity *= 2;
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(indexBufferCapacity * sizeof(std::uint32_t)), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, indexBinding, indexBuffer);
+    }
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(lightIndices.size() * sizeof(std::uint32_t)), lightIndices.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+float ClusteredLights::GetNearPlane() const { return nearPlane; }
+
+float ClusteredLights::GetFarPlane() const { return farPlane; }
+
+std::size_t ClusteredLights::GetActiveLights() const { return activeLights; }
+
+std::size_t ClusteredLights::GetAssignedIndices() const { return pairs.size() / 2; }
@@ -0,0 +1,82 @@
+#ifndef PROYECTOFINAL_CGA_CLUSTEREDLIGHTS_H
+#define PROYECTOFINAL_CGA_CLUSTEREDLIGHTS_H
+
+#include "Lights/PointLight.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Bins the point lights into view space froxels so the fragment shader only
+ * walks the lights that can reach its cluster.
+ *
+ * The grid size must match the CLUSTER_GRID constant in base.frag.
+ */
+class ClusteredLights
+{
+  public:
+    static constexpr std::uint32_t GridX = 16;
+    static constexpr std::uint32_t GridY = 9;
+    static constexpr std::uint32_t GridZ = 24;
+    static constexpr std::uint32_t ClusterCount = GridX * GridY * GridZ;
+
+  private:
+    unsigned int gridBinding;
+    unsigned int indexBinding;
+    unsigned int gridBuffer = 0;
+    unsigned int indexBuffer = 0;
+    std::size_t indexBufferCapacity = 0;
+
+    glm::mat4 lastProjection{0.0f};
+    float nearPlane = 0.1f;
+    float farPlane = 100.0f;
+
+    // Cluster bounds in view space, stored as SoA so the overlap test vectorizes
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+    std::vector<std::uint8_t> overlap;
+    std::vector<std::uint32_t> clusterCounts;
+    std::vector<std::uint32_t> clusterData; // (offset, count) pairs
+    std::vector<std::uint32_t> lightIndices;
+    std::vector<std::uint32_t> pairs; // (cluster, light) produced while binning
+    std::size_t activeLights = 0;
+
+    void BuildClusterBounds(const glm::mat4 &projection);
+
+    [[nodiscard]] std::uint32_t SliceFromDepth(float depth) const;
+
+  public:
+    explicit ClusteredLights(unsigned int gridBindingPoint = 5, unsigned int indexBindingPoint = 6);
+
+    ClusteredLights(const ClusteredLights &) = delete;
+
+    ClusteredLights &operator=(const ClusteredLights &) = delete;
+
+    ~ClusteredLights();
+
+    void Init();
+
+    /// Starts a new light assignment for this view, the cluster bounds are rebuilt only if the projection changed.
+    void Begin(const glm::mat4 &projection, float near, float far);
+
+    /// Adds the light to every cluster its influence sphere overlaps, index is its position in the lights SSBO.
+    void AddLight(const glm::mat4 &view, const Lights::PointLight &light, std::uint32_t index);
+
+    /// Builds the compact per cluster lists and uploads them to the GPU.
+    void Upload();
+
+    /// Distance at which the light contribution falls below what a 8 bit channel can show.
+    static float LightRadius(const Lights::PointLight &light, float maxRadius);
+
+    [[nodiscard]] float GetNearPlane() const;
+
+    [[nodiscard]] float GetFarPlane() const;
+
+    [[nodiscard]] std::size_t GetActiveLights() const;
+
+    [[nodiscard]] std::size_t GetAssignedIndices() const;
+};
+
+#endif // PROYECTOFINAL_CGA_CLUSTEREDLIGHTS_H
@@ -0,0 +1,131 @@
+#include "GlobalDefines.h"
+
+#include "DebugDraw.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <utility>
+
+DebugDraw::~DebugDraw()
+{
+    if (vbo != 0) glDeleteBuffers(1, &vbo);
+    if (vao != 0) glDeleteVertexArrays(1, &vao);
+}
+
+void DebugDraw::Init()
+{
+    bufferCapacity = 4096;
+    vertices.reserve(bufferCapacity);
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(bufferCapacity * sizeof(Vertex)), nullptr, GL_STREAM_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, position)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, color)));
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void DebugDraw::Line(const glm::vec3 &from, const glm::vec3 &to, const glm::vec3 &color)
+{
+    vertices.push_back({from, color});
+    vertices.push_back({to, color});
+}
+
+void DebugDraw::Box(const glm::vec3 &min, const glm::vec3 &max, const glm::vec3 &color)
+{
+    const glm::vec3 center = (min + max) * 0.5f;
+    OBB(center, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), max - center, color);
+}
+
+void DebugDraw::OBB(const glm::vec3 &center, const glm::quat &rotation, const glm::vec3 &halfExtents, const glm::vec3 &color)
+{
+    const glm::mat3 axes = glm::mat3_cast(rotation);
+    const glm::vec3 x = axes[0] * halfExtents.x;
+    const glm::vec3 y = axes[1] * halfExtents.y;
+    const glm::vec3 z = axes[2] * halfExtents.z;
+
+    // Corner i has the sign of x, y and z in its bits 0, 1 and 2
+    std::array<glm::vec3, 8> corners;
+    for (int i = 0; i < 8; i++)
+        corners[i] = center + (i & 1 ? x : -x) + (i & 2 ? y : -y) + (i & 4 ? z : -z);
+
+    constexpr std::array<std::pair<int, int>, 12> edges = {
+        {{0, 1}, {2, 3}, {4, 5}, {6, 7}, {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7}}
+    };
+    for (const auto &[a, b] : edges)
+        Line(corners[a], corners[b], color);
+}
+
+void DebugDraw::Ray(const glm::vec3 &origin, const glm::vec3 &direction, const float length, const glm::vec3 &color)
+{
+    Line(origin, origin + glm::normalize(direction) * length, color);
+}
+
+void DebugDraw::Sphere(const glm::vec3 &center, const float radius, const glm::vec3 &color, const int segments)
+{
+    const float step = 2.0f * std::numbers::pi_v<float> / static_cast<float>(segments);
+    for (int i = 0; i < segments; i++)
+    {
+        const float a0 = step * static_cast<float>(i);
+        const float a1 = step * static_cast<float>(i + 1);
+        const float c0 = std::cos(a0) * radius, s0 = std::sin(a0) * radius;
+        const float c1 = std::cos(a1) * radius, s1 = std::sin(a1) * radius;
+
+        Line(center + glm::vec3(c0, s0, 0.0f), center + glm::vec3(c1, s1, 0.0f), color);
+        Line(center + glm::vec3(c0, 0.0f, s0), center + glm::vec3(c1, 0.0f, s1), color);
+        Line(center + glm::vec3(0.0f, c0, s0), center + glm::vec3(0.0f, c1, s1), color);
+    }
+}
+
+void DebugDraw::Text(const glm::vec3 &position, std::string text, const glm::vec4 &color)
+{
+    labels.push_back({position, color, std::move(text)});
+}
+
+void DebugDraw::Flush(Shader &shader, const glm::mat4 &viewProjection, FontType *font)
+{
+    lastLineCount = vertices.size() / 2;
+
+    if (!vertices.empty())
+    {
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        while (bufferCapacity < vertices.size())
+            bufferCapacity *= 2;
+        // Orphan the previous storage, the driver hands out a fresh block instead of waiting for last frame's draw
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(bufferCapacity * sizeof(Vertex)), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)), vertices.data());
+
+        shader.Use();
+        shader.Set<4, 4>("viewProjection", viewProjection);
+        glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(vertices.size()));
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        vertices.clear();
+    }
+
+    if (font)
+    {
+        for (const auto &[position, color, text] : labels)
+        {
+            const glm::vec4 clip = viewProjection * glm::vec4(position, 1.0f);
+            if (clip.w <= 0.0f) continue;
+            const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            if (std::abs(ndc.x) > 1.0f || std::abs(ndc.y) > 1.0f) continue;
+            font->SetColor(color).Render(ndc.x, ndc.y, text);
+        }
+    }
+    labels.clear();
+}
+
+std::size_t DebugDraw::GetLineCount() const { return lastLineCount; }
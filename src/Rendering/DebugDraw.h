@@ -0,0 +1,76 @@
+#ifndef PROYECTOFINAL_CGA_DEBUGDRAW_H
+#define PROYECTOFINAL_CGA_DEBUGDRAW_H
+
+#include "FontType.h"
+#include "Shader.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Immediate mode debug geometry.
+ *
+ * Shapes are turned into colored line segments on the CPU and accumulated
+ * during the frame, Flush streams them into one vertex buffer and draws them
+ * all with a single GL_LINES call. Labels are projected to the screen and
+ * drawn with the given font.
+ */
+class DebugDraw
+{
+    struct Vertex
+    {
+        glm::vec3 position;
+        glm::vec3 color;
+    };
+
+    struct Label
+    {
+        glm::vec3 position;
+        glm::vec4 color;
+        std::string text;
+    };
+
+    unsigned int vao = 0;
+    unsigned int vbo = 0;
+    std::size_t bufferCapacity = 0;
+
+    std::vector<Vertex> vertices;
+    std::vector<Label> labels;
+    std::size_t lastLineCount = 0;
+
+  public:
+    DebugDraw() = default;
+
+    DebugDraw(const DebugDraw &) = delete;
+
+    DebugDraw &operator=(const DebugDraw &) = delete;
+
+    ~DebugDraw();
+
+    void Init();
+
+    void Line(const glm::vec3 &from, const glm::vec3 &to, const glm::vec3 &color);
+
+    void Box(const glm::vec3 &min, const glm::vec3 &max, const glm::vec3 &color);
+
+    void OBB(const glm::vec3 &center, const glm::quat &rotation, const glm::vec3 &halfExtents, const glm::vec3 &color);
+
+    void Ray(const glm::vec3 &origin, const glm::vec3 &direction, float length, const glm::vec3 &color);
+
+    /// Three great circles, one per axis.
+    void Sphere(const glm::vec3 &center, float radius, const glm::vec3 &color, int segments = 16);
+
+    void Text(const glm::vec3 &position, std::string text, const glm::vec4 &color = glm::vec4(1.0f));
+
+    /// Draws everything accumulated since the last flush and clears it, labels are skipped without a font.
+    void Flush(Shader &shader, const glm::mat4 &viewProjection, FontType *font = nullptr);
+
+    /// Segments drawn by the last flush.
+    [[nodiscard]] std::size_t GetLineCount() const;
+};
+
+#endif // PROYECTOFINAL_CGA_DEBUGDRAW_H
@@ -0,0 +1,54 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+DynamicResolution::DynamicResolution(const int minimumWidth, const int maximumWidth, const int initialWidth, const int widthStep) :
+    minWidth(minimumWidth),
+    maxWidth(maximumWidth),
+    step(widthStep),
+    width(0)
+{
+    width = Quantize(static_cast<float>(initialWidth));
+}
+
+int DynamicResolution::Quantize(const float value) const
+{
+    const int quantized = static_cast<int>(std::round(value / static_cast<float>(step))) * step;
+    return std::clamp(quantized, minWidth, maxWidth);
+}
+
+bool DynamicResolution::Update(const float gpuMilliseconds, const float targetMilliseconds)
+{
+    smoothedMs = smoothedMs == 0.0f ? gpuMilliseconds : smoothedMs * 0.9f + gpuMilliseconds * 0.1f;
+    if (++framesSinceChange < cooldownFrames) return false;
+
+    // Leave some headroom below the target and only grow when clearly under it
+    const float upper = targetMilliseconds * 0.95f;
+    const float lower = targetMilliseconds * 0.75f;
+    if (smoothedMs <= upper && smoothedMs >= lower) return false;
+
+    // Pixel cost grows with the area, the width with its square root
+    const float scale = std::sqrt(upper / std::max(smoothedMs, 0.01f));
+    const int newWidth = Quantize(static_cast<float>(width) * std::clamp(scale, 0.75f, 1.25f));
+    if (newWidth == width) return false;
+
+    width = newWidth;
+    framesSinceChange = 0;
+    // The smoothed value describes the old resolution, start again from the next samples
+    smoothedMs = 0.0f;
+    return true;
+}
+
+void DynamicResolution::SetBounds(const int minimumWidth, const int maximumWidth)
+{
+    minWidth = std::min(minimumWidth, maximumWidth);
+    maxWidth = std::max(minimumWidth, maximumWidth);
+    width = Quantize(static_cast<float>(width));
+}
+
+void DynamicResolution::SetWidth(const int newWidth) { width = Quantize(static_cast<float>(newWidth)); }
+
+int DynamicResolution::GetWidth() const { return width; }
+
+float DynamicResolution::GetSmoothedMilliseconds() const { return smoothedMs; }
@@ -0,0 +1,38 @@
+#ifndef PROYECTOFINAL_CGA_DYNAMICRESOLUTION_H
+#define PROYECTOFINAL_CGA_DYNAMICRESOLUTION_H
+
+/**
+ * Picks the internal render width of the pixelate framebuffer from the
+ * measured GPU frame time.
+ *
+ * The width is always a multiple of the step, and changes are rate limited,
+ * so the framebuffer is only reallocated when the new size is worth it.
+ */
+class DynamicResolution
+{
+    int minWidth;
+    int maxWidth;
+    int step;
+    int width;
+    float smoothedMs = 0.0f;
+    int framesSinceChange = 0;
+    int cooldownFrames = 30;
+
+    [[nodiscard]] int Quantize(float value) const;
+
+  public:
+    DynamicResolution(int minimumWidth, int maximumWidth, int initialWidth, int widthStep = 64);
+
+    /// Feeds a new GPU frame time, returns true when the width changed.
+    bool Update(float gpuMilliseconds, float targetMilliseconds);
+
+    void SetBounds(int minimumWidth, int maximumWidth);
+
+    void SetWidth(int newWidth);
+
+    [[nodiscard]] int GetWidth() const;
+
+    [[nodiscard]] float GetSmoothedMilliseconds() const;
+};
+
+#endif // PROYECTOFINAL_CGA_DYNAMICRESOLUTION_H
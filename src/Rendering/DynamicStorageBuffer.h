@@ -0,0 +1,235 @@
+#ifndef PROYECTOFINAL_CGA_DYNAMICSTORAGEBUFFER_H
+#define PROYECTOFINAL_CGA_DYNAMICSTORAGEBUFFER_H
+
+#include "GlobalDefines.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+/**
+ * Shader storage buffer backed by a CPU array, drop-in for StorageBufferDynamicArray.
+ *
+ * Changes are only recorded (Add, Remove, UpdateIndex) and written to the GPU in
+ * Flush, once per frame, as a single coalesced range. On GL 4.4+ the buffer is
+ * persistently mapped and split in three regions used round robin, each one
+ * guarded by a fence, so writing never waits for the GPU to finish reading the
+ * previous frames. Older contexts fall back to one glBufferSubData per frame.
+ */
+template <typename T>
+class DynamicStorageBuffer
+{
+    static constexpr std::size_t Regions = 3;
+
+    struct DirtyRange
+    {
+        std::size_t begin = 0;
+        std::size_t end = 0;
+
+        [[nodiscard]] bool Empty() const { return begin >= end; }
+    };
+
+    GLuint binding;
+    GLuint buffer = 0;
+    std::vector<T> data;
+    std::size_t capacity = 0;
+    std::size_t regionStride = 0;
+    bool persistent = false;
+    unsigned char *mapped = nullptr;
+
+    std::size_t currentRegion = 0;
+    bool regionInUse = false;
+    std::array<DirtyRange, Regions> dirty{};
+    std::array<GLsync, Regions> fences{};
+
+    std::size_t uploadedBytes = 0;
+    std::size_t flushes = 0;
+
+    void MarkDirty(const std::size_t begin, const std::size_t end)
+    {
+        for (auto &range : dirty)
+        {
+            if (range.Empty())
+                range = {begin, end};
+            else
+                range = {std::min(range.begin, begin), std::max(range.end, end)};
+        }
+    }
+
+    void Allocate(const std::size_t elements)
+    {
+        Release();
+
+        capacity = std::max<std::size_t>(elements, 1);
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+
+        if (persistent)
+        {
+            GLint alignment = 1;
+            glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+            const auto align = static_cast<std::size_t>(alignment);
+            regionStride = (capacity * sizeof(T) + align - 1) / align * align;
+
+            constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(regionStride * Regions), nullptr, flags);
+            mapped = static_cast<unsigned char *>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(regionStride * Regions), flags));
+        }
+        else
+        {
+            regionStride = capacity * sizeof(T);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(regionStride), nullptr, GL_DYNAMIC_DRAW);
+        }
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        regionInUse = false;
+        MarkDirty(0, data.size());
+    }
+
+    void Release()
+    {
+        for (auto &fence : fences)
+        {
+            if (fence) glDeleteSync(fence);
+            fence = nullptr;
+        }
+
+        if (buffer == 0) return;
+        if (mapped)
+        {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+            glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            mapped = nullptr;
+        }
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+
+    void Reserve(const std::size_t elements)
+    {
+        if (elements <= capacity) return;
+        std::size_t newCapacity = std::max<std::size_t>(capacity, 1);
+        while (newCapacity < elements)
+            newCapacity *= 2;
+        Allocate(newCapacity);
+    }
+
+    static void WaitFence(GLsync &fence)
+    {
+        if (!fence) return;
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        while (result == GL_TIMEOUT_EXPIRED)
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+  public:
+    explicit DynamicStorageBuffer(const GLuint bindingPoint, const std::size_t initialCapacity = 16) :
+        binding(bindingPoint)
+    {
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        persistent = major > 4 || (major == 4 && minor >= 4);
+
+        data.reserve(initialCapacity);
+        Allocate(initialCapacity);
+    }
+
+    DynamicStorageBuffer(const DynamicStorageBuffer &) = delete;
+
+    DynamicStorageBuffer &operator=(const DynamicStorageBuffer &) = delete;
+
+    ~DynamicStorageBuffer() { Release(); }
+
+    void Add(const T &element)
+    {
+        data.push_back(element);
+        Reserve(data.size());
+        MarkDirty(data.size() - 1, data.size());
+    }
+
+    void Remove(const std::size_t index)
+    {
+        if (index >= data.size()) return;
+        data.erase(data.begin() + static_cast<std::ptrdiff_t>(index));
+        MarkDirty(index, data.size());
+    }
+
+    /// Marks the element as modified, it is uploaded on the next Flush.
+    void UpdateIndex(const std::size_t index)
+    {
+        if (index >= data.size()) return;
+        MarkDirty(index, index + 1);
+    }
+
+    /// Writes every pending change in one go and binds the region the GPU has to read this frame.
+    void Flush()
+    {
+        if (persistent)
+        {
+            // Everything reading the previous region was issued during the last frame
+            if (regionInUse)
+            {
+                // The region's older fence is only waited on when it gets rewritten, a clean buffer would leak it
+                if (fences[currentRegion]) glDeleteSync(fences[currentRegion]);
+                fences[currentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                currentRegion = (currentRegion + 1) % Regions;
+            }
+
+            auto &range = dirty[currentRegion];
+            if (!range.Empty())
+            {
+                WaitFence(fences[currentRegion]);
+                const std::size_t end = std::min(range.end, data.size());
+                if (range.begin < end)
+                {
+                    std::memcpy(mapped + currentRegion * regionStride + range.begin * sizeof(T), data.data() + range.begin, (end - range.begin) * sizeof(T));
+                    uploadedBytes += (end - range.begin) * sizeof(T);
+                    flushes++;
+                }
+                range = {};
+            }
+
+            glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, buffer, static_cast<GLintptr>(currentRegion * regionStride), static_cast<GLsizeiptr>(capacity * sizeof(T)));
+            regionInUse = true;
+            return;
+        }
+
+        auto &range = dirty[0];
+        const std::size_t end = std::min(range.end, data.size());
+        if (range.begin < end)
+        {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, static_cast<GLintptr>(range.begin * sizeof(T)), static_cast<GLsizeiptr>((end - range.begin) * sizeof(T)), data.data() + range.begin);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            uploadedBytes += (end - range.begin) * sizeof(T);
+            flushes++;
+        }
+        dirty = {};
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+    }
+
+    T &operator[](const std::size_t index) { return data[index]; }
+
+    const T &operator[](const std::size_t index) const { return data[index]; }
+
+    [[nodiscard]] std::size_t Size() const { return data.size(); }
+
+    [[nodiscard]] std::size_t Capacity() const { return capacity; }
+
+    [[nodiscard]] const T *Data() const { return data.data(); }
+
+    [[nodiscard]] bool IsPersistent() const { return persistent; }
+
+    /// Bytes written to the GPU since the last call, for the debug GUI.
+    std::size_t ConsumeUploadedBytes() { return std::exchange(uploadedBytes, 0); }
+
+    std::size_t ConsumeFlushes() { return std::exchange(flushes, 0); }
+};
+
+#endif // PROYECTOFINAL_CGA_DYNAMICSTORAGEBUFFER_H
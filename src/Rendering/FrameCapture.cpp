@@ -0,0 +1,348 @@
+#include "GlobalDefines.h"
+
+#include "FrameCapture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <string_view>
+#include <system_error>
+
+namespace
+{
+std::uint32_t Crc32(const unsigned char *data, const std::size_t size, std::uint32_t crc = 0)
+{
+    static const auto table = []
+    {
+        std::array<std::uint32_t, 256> values{};
+        for (std::uint32_t i = 0; i < values.size(); i++)
+        {
+            std::uint32_t value = i;
+            for (int bit = 0; bit < 8; bit++)
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            values[i] = value;
+        }
+        return values;
+    }();
+
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void AppendBigEndian(std::vector<unsigned char> &out, const std::uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.push_back(static_cast<unsigned char>(value >> shift));
+}
+
+void AppendChunk(std::vector<unsigned char> &png, const std::string_view type, const std::vector<unsigned char> &data)
+{
+    AppendBigEndian(png, static_cast<std::uint32_t>(data.size()));
+    const std::size_t typeStart = png.size();
+    png.insert(png.end(), type.begin(), type.end());
+    png.insert(png.end(), data.begin(), data.end());
+    AppendBigEndian(png, Crc32(png.data() + typeStart, png.size() - typeStart));
+}
+
+/// RGBA, top row first. The deflate blocks are stored, speed matters more than size here.
+bool WritePng(const std::filesystem::path &path, const std::vector<unsigned char> &pixels, const int width, const int height)
+{
+    const std::size_t stride = static_cast<std::size_t>(width) * 4;
+    std::vector<unsigned char> rows;
+    rows.reserve((stride + 1) * static_cast<std::size_t>(height));
+    for (int row = 0; row < height; row++)
+    {
+        // Filter type 0, the row as is
+        rows.push_back(0);
+        rows.insert(rows.end(), pixels.begin() + static_cast<std::ptrdiff_t>(row * stride), pixels.begin() + static_cast<std::ptrdiff_t>((row + 1) * stride));
+    }
+
+    std::vector<unsigned char> zlib = {0x78, 0x01};
+    constexpr std::size_t maxBlock = 65535;
+    for (std::size_t offset = 0; offset < rows.size(); offset += maxBlock)
+    {
+        const std::size_t block = std::min(maxBlock, rows.size() - offset);
+        const auto length = static_cast<std::uint16_t>(block);
+        const auto inverse = static_cast<std::uint16_t>(~length);
+        zlib.push_back(offset + block == rows.size() ? 1 : 0);
+        zlib.push_back(static_cast<unsigned char>(length));
+        zlib.push_back(static_cast<unsigned char>(length >> 8));
+        zlib.push_back(static_cast<unsigned char>(inverse));
+        zlib.push_back(static_cast<unsigned char>(inverse >> 8));
+        zlib.insert(zlib.end(), rows.begin() + static_cast<std::ptrdiff_t>(offset), rows.begin() + static_cast<std::ptrdiff_t>(offset + block));
+    }
+    std::uint32_t a = 1, b = 0;
+    for (const unsigned char value : rows)
+    {
+        a = (a + value) % 65521;
+        b = (b + a) % 65521;
+    }
+    AppendBigEndian(zlib, (b << 16) | a);
+
+    std::vector<unsigned char> header;
+    AppendBigEndian(header, static_cast<std::uint32_t>(width));
+    AppendBigEndian(header, static_cast<std::uint32_t>(height));
+    // 8 bits per channel, RGBA, deflate, adaptive filters, no interlacing
+    header.insert(header.end(), {8, 6, 0, 0, 0});
+
+    std::vector<unsigned char> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    AppendChunk(png, "IHDR", header);
+    AppendChunk(png, "IDAT", zlib);
+    AppendChunk(png, "IEND", {});
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(png.data()), static_cast<std::streamsize>(png.size()));
+    return static_cast<bool>(file);
+}
+
+void CreateParentDirectory(const std::filesystem::path &path)
+{
+    std::error_code error;
+    if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), error);
+}
+} // namespace
+
+FrameCapture::~FrameCapture() { Finish(); }
+
+void FrameCapture::Init()
+{
+    for (Slot &slot : slots)
+        glGenBuffers(1, &slot.buffer);
+    worker = std::thread(&FrameCapture::Run, this);
+}
+
+void FrameCapture::RequestScreenshot(std::filesystem::path path) { pendingScreenshot = std::move(path); }
+
+void FrameCapture::StartRecording(const std::filesystem::path &path)
+{
+    StopRecording();
+    Push({.kind = Job::Kind::StartVideo, .path = path});
+    recording = true;
+}
+
+void FrameCapture::StopRecording()
+{
+    if (!recording) return;
+    Push({.kind = Job::Kind::EndVideo});
+    recording = false;
+}
+
+bool FrameCapture::IsRecording() const { return recording; }
+
+void FrameCapture::Capture(const int width, const int height)
+{
+    const auto start = std::chrono::steady_clock::now();
+    Collect(false);
+
+    if ((!pendingScreenshot.empty() || recording) && width > 0 && height > 0)
+    {
+        Slot &slot = slots[current];
+        // Every slot is still in flight, drop this frame instead of waiting for it
+        if (slot.pending)
+            framesDropped++;
+        else
+        {
+            const std::size_t size = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+            if (slot.capacity != size)
+            {
+                glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+                slot.capacity = size;
+            }
+            glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            slot.width = width;
+            slot.height = height;
+            slot.video = recording;
+            slot.screenshot = std::move(pendingScreenshot);
+            pendingScreenshot.clear();
+            slot.pending = true;
+            current = (current + 1) % Latency;
+        }
+    }
+
+    mainThreadMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void FrameCapture::Collect(const bool wait)
+{
+    // Oldest slot first, the one about to be reused is the oldest one
+    for (int i = 0; i < Latency; i++)
+    {
+        Slot &slot = slots[(current + i) % Latency];
+        if (!slot.pending) continue;
+
+        const auto fence = static_cast<GLsync>(slot.fence);
+        const GLenum status = wait ? glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) : glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) break;
+
+        glDeleteSync(fence);
+        slot.fence = nullptr;
+        slot.pending = false;
+        if (status == GL_WAIT_FAILED)
+        {
+            framesDropped++;
+            continue;
+        }
+
+        Job job{.kind = Job::Kind::Frame, .width = slot.width, .height = slot.height, .video = slot.video, .path = std::move(slot.screenshot)};
+        slot.screenshot.clear();
+        {
+            std::lock_guard lock(mutex);
+            if (!freeBuffers.empty())
+            {
+                job.pixels = std::move(freeBuffers.back());
+                freeBuffers.pop_back();
+            }
+        }
+        const std::size_t size = static_cast<std::size_t>(slot.width) * static_cast<std::size_t>(slot.height) * 4;
+        job.pixels.resize(size);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        if (const void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT))
+        {
+            std::memcpy(job.pixels.data(), data, size);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            if (!Push(std::move(job))) framesDropped++;
+        }
+        else
+            framesDropped++;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+}
+
+bool FrameCapture::Push(Job &&job)
+{
+    {
+        std::lock_guard lock(mutex);
+        // Only frames can be dropped, the recording must still start and end
+        if (job.kind == Job::Kind::Frame && jobs.size() >= MaxQueuedJobs)
+        {
+            freeBuffers.push_back(std::move(job.pixels));
+            return false;
+        }
+        jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+    return true;
+}
+
+void FrameCapture::Run()
+{
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) return;
+
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        Write(job);
+        lock.lock();
+        if (job.kind == Job::Kind::Frame) freeBuffers.push_back(std::move(job.pixels));
+    }
+}
+
+void FrameCapture::Write(Job &job)
+{
+    switch (job.kind)
+    {
+    case Job::Kind::StartVideo:
+        videoPath = job.path;
+        CreateParentDirectory(videoPath);
+        video.open(videoPath, std::ios::binary | std::ios::trunc);
+        if (!video) std::cerr << "\033[31mCannot open " << videoPath << " for the recording\033[0m\n";
+        videoWidth = 0;
+        videoHeight = 0;
+        videoFrames = 0;
+        return;
+    case Job::Kind::EndVideo:
+        if (!video.is_open()) return;
+        video.close();
+        std::cout << std::format("Recorded {} frames of {}x{} to {}, convert with: ffmpeg -f rawvideo -pix_fmt rgba -s {}x{} -r 60 -i {} capture.mp4\n",
+                                 videoFrames, videoWidth, videoHeight, videoPath.string(), videoWidth, videoHeight, videoPath.string());
+        return;
+    case Job::Kind::Frame:
+        break;
+    }
+
+    // OpenGL rows start at the bottom of the image
+    const std::size_t stride = static_cast<std::size_t>(job.width) * 4;
+    for (int row = 0; row < job.height / 2; row++)
+    {
+        unsigned char *top = job.pixels.data() + static_cast<std::size_t>(row) * stride;
+        unsigned char *bottom = job.pixels.data() + static_cast<std::size_t>(job.height - 1 - row) * stride;
+        std::swap_ranges(top, top + stride, bottom);
+    }
+
+    bool written = false;
+    if (job.video && video.is_open())
+    {
+        if (videoFrames == 0)
+        {
+            videoWidth = job.width;
+            videoHeight = job.height;
+        }
+        // A raw stream has a single frame size, the frames after a resize are dropped
+        if (job.width == videoWidth && job.height == videoHeight)
+        {
+            video.write(reinterpret_cast<const char *>(job.pixels.data()), static_cast<std::streamsize>(job.pixels.size()));
+            videoFrames++;
+            written = true;
+        }
+        else
+            framesDropped++;
+    }
+
+    if (!job.path.empty())
+    {
+        CreateParentDirectory(job.path);
+        if (WritePng(job.path, job.pixels, job.width, job.height))
+        {
+            std::cout << "Screenshot saved to " << job.path.string() << "\n";
+            written = true;
+        }
+        else
+            std::cerr << "\033[31mCannot write the screenshot " << job.path << "\033[0m\n";
+    }
+
+    if (written) framesWritten++;
+}
+
+void FrameCapture::Finish()
+{
+    if (!worker.joinable()) return;
+
+    Collect(true);
+    StopRecording();
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+
+    for (Slot &slot : slots)
+    {
+        if (slot.fence) glDeleteSync(static_cast<GLsync>(slot.fence));
+        glDeleteBuffers(1, &slot.buffer);
+        slot = {};
+    }
+}
+
+FrameCaptureStats FrameCapture::GetStats() const
+{
+    return {
+        .mainThreadMilliseconds = mainThreadMilliseconds,
+        .framesWritten = framesWritten.load(),
+        .framesDropped = framesDropped.load(),
+    };
+}
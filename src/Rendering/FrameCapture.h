@@ -0,0 +1,136 @@
+#ifndef PROYECTOFINAL_CGA_FRAMECAPTURE_H
+#define PROYECTOFINAL_CGA_FRAMECAPTURE_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct FrameCaptureStats
+{
+    /// Readback and copy of the last captured frame, the time Capture took.
+    float mainThreadMilliseconds = 0.0f;
+    std::uint32_t framesWritten = 0;
+    std::uint32_t framesDropped = 0;
+};
+
+/**
+ * Reads finished frames back into a ring of pixel buffer objects and writes
+ * them from a worker thread.
+ *
+ * glReadPixels into a PBO returns right away, the GPU does the copy. Every
+ * slot gets a fence and is mapped a few frames later, only once its fence is
+ * signaled, so the main thread never waits for the GPU. The mapped pixels are
+ * copied into a recycled buffer for the worker, which flips the rows and
+ * writes an (uncompressed) PNG for screenshots or appends raw RGBA frames to
+ * the recording. A frame is dropped, never waited for, when every slot is in
+ * flight or the worker falls behind.
+ */
+class FrameCapture
+{
+    static constexpr int Latency = 3;
+    static constexpr std::size_t MaxQueuedJobs = 8;
+
+    struct Slot
+    {
+        unsigned int buffer = 0;
+        std::size_t capacity = 0;
+        void *fence = nullptr;
+        int width = 0;
+        int height = 0;
+        bool video = false;
+        std::filesystem::path screenshot;
+        bool pending = false;
+    };
+
+    struct Job
+    {
+        enum class Kind : std::uint8_t
+        {
+            Frame,
+            StartVideo,
+            EndVideo
+        };
+
+        Kind kind = Kind::Frame;
+        std::vector<unsigned char> pixels;
+        int width = 0;
+        int height = 0;
+        bool video = false;
+        // Screenshot of a frame, file of a recording
+        std::filesystem::path path;
+    };
+
+    std::array<Slot, Latency> slots{};
+    int current = 0;
+    std::filesystem::path pendingScreenshot;
+    bool recording = false;
+    float mainThreadMilliseconds = 0.0f;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    std::vector<std::vector<unsigned char>> freeBuffers;
+    bool stopping = false;
+    std::atomic<std::uint32_t> framesWritten = 0;
+    std::atomic<std::uint32_t> framesDropped = 0;
+
+    // Worker only
+    std::ofstream video;
+    std::filesystem::path videoPath;
+    int videoWidth = 0;
+    int videoHeight = 0;
+    std::uint32_t videoFrames = 0;
+
+    /// Maps the slots whose fence is signaled, oldest first. Waits for them only if told to.
+    void Collect(bool wait);
+
+    /// Hands a job to the worker, false if it is too far behind.
+    bool Push(Job &&job);
+
+    void Run();
+
+    void Write(Job &job);
+
+  public:
+    FrameCapture() = default;
+
+    FrameCapture(const FrameCapture &) = delete;
+
+    FrameCapture &operator=(const FrameCapture &) = delete;
+
+    ~FrameCapture();
+
+    void Init();
+
+    /// The next captured frame is also saved as a PNG at the path.
+    void RequestScreenshot(std::filesystem::path path);
+
+    /// Every captured frame is appended to the file as raw RGBA until StopRecording.
+    void StartRecording(const std::filesystem::path &path);
+
+    void StopRecording();
+
+    [[nodiscard]] bool IsRecording() const;
+
+    /**
+     * Queues the readback of the bound read framebuffer, call it once the
+     * frame is finished. Also hands the readbacks that are done to the worker.
+     */
+    void Capture(int width, int height);
+
+    /// Writes the frames still in flight and stops the worker, the GL context must still exist.
+    void Finish();
+
+    [[nodiscard]] FrameCaptureStats GetStats() const;
+};
+
+#endif // PROYECTOFINAL_CGA_FRAMECAPTURE_H
@@ -0,0 +1,55 @@
+#include "GlobalDefines.h"
+
+#include "GpuTimer.h"
+
+GpuTimer::~GpuTimer()
+{
+    if (queries[0] != 0) glDeleteQueries(Latency, queries.data());
+}
+
+void GpuTimer::Init() { glGenQueries(Latency, queries.data()); }
+
+void GpuTimer::Begin()
+{
+    // The slot is still in flight, drop this frame instead of waiting for it
+    if (running || pending[current]) return;
+    glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+    running = true;
+}
+
+void GpuTimer::End()
+{
+    // Poll may free the slot between a skipped Begin and this End, only the flag says a query is active
+    if (!running) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    running = false;
+    pending[current] = true;
+    current = (current + 1) % Latency;
+}
+
+bool GpuTimer::Poll()
+{
+    bool updated = false;
+    // Oldest query first, the slot about to be reused is the oldest one
+    for (int i = 0; i < Latency; i++)
+    {
+        const int slot = (current + i) % Latency;
+        if (!pending[slot]) continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &elapsed);
+        lastMilliseconds = static_cast<float>(static_cast<double>(elapsed) / 1.0e6);
+        pending[slot] = false;
+        hasResult = true;
+        updated = true;
+    }
+    return updated;
+}
+
+float GpuTimer::GetMilliseconds() const { return lastMilliseconds; }
+
+bool GpuTimer::HasResult() const { return hasResult; }
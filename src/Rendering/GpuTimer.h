@@ -0,0 +1,47 @@
+#ifndef PROYECTOFINAL_CGA_GPUTIMER_H
+#define PROYECTOFINAL_CGA_GPUTIMER_H
+
+#include <array>
+
+/**
+ * Measures GPU time with a ring of GL_TIME_ELAPSED queries.
+ *
+ * Results are read a few frames later and only when available, so the timer
+ * never stalls the pipeline. Only one timer can be running at a time.
+ */
+class GpuTimer
+{
+    static constexpr int Latency = 4;
+
+    std::array<unsigned int, Latency> queries{};
+    std::array<bool, Latency> pending{};
+    int current = 0;
+    // Set by a Begin that started a query, a skipped frame has nothing to end
+    bool running = false;
+    float lastMilliseconds = 0.0f;
+    bool hasResult = false;
+
+  public:
+    GpuTimer() = default;
+
+    GpuTimer(const GpuTimer &) = delete;
+
+    GpuTimer &operator=(const GpuTimer &) = delete;
+
+    ~GpuTimer();
+
+    void Init();
+
+    void Begin();
+
+    void End();
+
+    /// Collects the oldest finished query, returns true if a new measurement arrived.
+    bool Poll();
+
+    [[nodiscard]] float GetMilliseconds() const;
+
+    [[nodiscard]] bool HasResult() const;
+};
+
+#endif // PROYECTOFINAL_CGA_GPUTIMER_H
@@ -0,0 +1,82 @@
+#include "GlobalDefines.h"
+
+#include "LodLibrary.h"
+
+#include "MeshOptimizer.h"
+
+#include <filesystem>
+#include <iostream>
+
+bool LodLibrary::Cook(const std::string &path)
+{
+    if (std::filesystem::path(path).extension() != ".obj") return false;
+
+    std::error_code error;
+    const auto sourceTime = std::filesystem::last_write_time(path, error);
+    if (error) return false;
+
+    bool cooked = true;
+    for (int level = 1; level < MaxLodLevels; level++)
+    {
+        const std::string lodPath = MeshOptimizer::LodPath(path, level);
+        if (!std::filesystem::exists(lodPath) || std::filesystem::last_write_time(lodPath, error) < sourceTime)
+            cooked = false;
+    }
+    if (cooked) return true;
+
+    std::cout << "Cooking LODs of " << path << '\n';
+    return MeshOptimizer::CookLods(path, {GridResolutions.begin(), GridResolutions.end()});
+}
+
+LodComponent LodLibrary::Load(Model &base, const std::string &path)
+{
+    LodComponent lod{.levels = {&base}};
+    if (!Cook(path)) return lod;
+
+    for (int level = 1; level < MaxLodLevels; level++)
+    {
+        const std::string lodPath = MeshOptimizer::LodPath(path, level);
+        const auto info = MeshOptimizer::ReadLodInfo(lodPath);
+        if (!info) break;
+
+        auto &model = models.emplace_back(std::make_unique<Model>(lodPath));
+        model->Load();
+
+        triangleCounts[&base] = info->sourceTriangles;
+        triangleCounts[model.get()] = info->triangles;
+        lod.levels[level] = model.get();
+        lod.levelCount = level + 1;
+        lod.boundingRadius = info->radius;
+    }
+
+    chains[&base] = lod;
+    return lod;
+}
+
+void LodLibrary::Reload(const Model &base, const std::string &path)
+{
+    const auto chain = chains.find(&base);
+    if (chain == chains.end()) return;
+
+    // The level count and the bounding radius of the spawned components stay as they were loaded
+    for (int level = 1; level < chain->second.levelCount; level++)
+    {
+        const std::string lodPath = MeshOptimizer::LodPath(path, level);
+        const auto info = MeshOptimizer::ReadLodInfo(lodPath);
+        if (!info) break;
+
+        Model *model = chain->second.levels[level];
+        *model = Model(lodPath);
+        model->Load();
+        triangleCounts[&base] = info->sourceTriangles;
+        triangleCounts[model] = info->triangles;
+    }
+}
+
+void LodLibrary::RecordTriangles(const Model &model, const std::size_t triangles) { triangleCounts[&model] = triangles; }
+
+std::size_t LodLibrary::GetTriangleCount(const Model *model) const
+{
+    const auto it = triangleCounts.find(model);
+    return it != triangleCounts.end() ? it->second : 0;
+}
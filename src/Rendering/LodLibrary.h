@@ -0,0 +1,48 @@
+#ifndef PROYECTOFINAL_CGA_LODLIBRARY_H
+#define PROYECTOFINAL_CGA_LODLIBRARY_H
+
+#include "../Components/LodComponent.h"
+#include "Model.h"
+
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Owns the simplified models of every LOD chain.
+ *
+ * The LODs are read from the cooked files next to the source model
+ * (<stem>_lod1.obj, <stem>_lod2.obj), they are cooked first when missing or
+ * older than the source. Only OBJ sources can be cooked, the LOD files reuse
+ * their material library.
+ */
+class LodLibrary
+{
+    std::vector<std::unique_ptr<Model>> models;
+    std::unordered_map<const Model *, std::size_t> triangleCounts;
+    // Chain of each base model, a reload replaces its levels in place
+    std::unordered_map<const Model *, LodComponent> chains;
+
+  public:
+    /// Grid cells along the largest axis for each generated level.
+    static constexpr std::array<int, MaxLodLevels - 1> GridResolutions = {32, 12};
+
+    /// Cooks the LOD files of an OBJ source when missing or older than it, without GL calls so any thread can do it.
+    static bool Cook(const std::string &path);
+
+    /// Builds the LOD chain of an already loaded model, the component has a single level if there are no LODs.
+    LodComponent Load(Model &base, const std::string &path);
+
+    /// Loads the cooked levels of a chain again after Cook, the components keep pointing to the same models.
+    void Reload(const Model &base, const std::string &path);
+
+    /// Triangle count of a model without LODs, from MeshOptimizer::CountTriangles.
+    void RecordTriangles(const Model &model, std::size_t triangles);
+
+    /// Triangles of the model, 0 if it was never recorded.
+    [[nodiscard]] std::size_t GetTriangleCount(const Model *model) const;
+};
+
+#endif // PROYECTOFINAL_CGA_LODLIBRARY_H
@@ -0,0 +1,624 @@
+#include "MeshOptimizer.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <unordered_map>
+
+namespace MeshOptimizer
+{
+namespace
+{
+// Tuning values from Forsyth's paper, the cache is bigger than the one used to measure the ACMR on purpose
+constexpr std::size_t ForsythCacheSize = 32;
+constexpr float CacheDecayPower = 1.5f;
+constexpr float LastTriangleScore = 0.75f;
+constexpr float ValenceBoostScale = 2.0f;
+constexpr float ValenceBoostPower = 0.5f;
+
+float VertexScore(const int cachePosition, const std::uint32_t remainingTriangles)
+{
+    if (remainingTriangles == 0) return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        // The vertices of the last triangle get a fixed score so the next triangle does not just reuse its edge
+        if (cachePosition < 3)
+            score = LastTriangleScore;
+        else
+        {
+            const float scaler = 1.0f / static_cast<float>(ForsythCacheSize - 3);
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, CacheDecayPower);
+        }
+    }
+
+    // Boost vertices with few triangles left so they are finished instead of left behind
+    return score + ValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -ValenceBoostPower);
+}
+
+struct VertexHash
+{
+    std::size_t operator()(const Vertex &vertex) const
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+        const auto *bytes = reinterpret_cast<const unsigned char *>(&vertex);
+        for (std::size_t i = 0; i < sizeof(Vertex); i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return static_cast<std::size_t>(hash);
+    }
+};
+
+struct VertexEqual
+{
+    bool operator()(const Vertex &a, const Vertex &b) const { return std::memcmp(&a, &b, sizeof(Vertex)) == 0; }
+};
+
+MeshStats Measure(const std::vector<std::uint32_t> &indices, const std::size_t vertexCount, const std::size_t vertexSize)
+{
+    return {
+        .vertices = vertexCount,
+        .triangles = indices.size() / 3,
+        .acmr = ComputeACMR(indices, vertexCount),
+        .vertexBytes = vertexCount * vertexSize,
+    };
+}
+
+/// Triangles of an imported mesh, faces that are not triangles are dropped.
+void ReadMesh(const aiMesh *mesh, std::vector<Vertex> &vertices, std::vector<std::uint32_t> &indices)
+{
+    vertices.resize(mesh->mNumVertices);
+    for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+    {
+        vertices[i].position = {mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z};
+        vertices[i].normal = mesh->HasNormals() ? glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z) : glm::vec3(0.0f);
+        vertices[i].uv = mesh->HasTextureCoords(0) ? glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y) : glm::vec2(0.0f);
+    }
+
+    indices.clear();
+    for (unsigned int f = 0; f < mesh->mNumFaces; f++)
+    {
+        const aiFace &face = mesh->mFaces[f];
+        if (face.mNumIndices != 3) continue;
+        indices.insert(indices.end(), face.mIndices, face.mIndices + 3);
+    }
+}
+
+/// The mtllib line of an OBJ, the cooked files live next to the source so they can point to the same library.
+std::string ReadMaterialLibrary(const std::string &source)
+{
+    std::ifstream sourceStream(source);
+    for (std::string line; std::getline(sourceStream, line);)
+    {
+        if (line.starts_with("mtllib ")) return line;
+    }
+    return {};
+}
+
+/// One OBJ object, a vertex is written once with the same position, uv and normal index so an import keeps the order.
+void WriteObjMesh(std::ostream &body, const aiScene *scene, const unsigned int mesh, const std::vector<Vertex> &vertices,
+                  const std::vector<std::uint32_t> &indices, std::size_t &vertexOffset)
+{
+    // Every float round-trips, the default 6 digits would move the vertices of large models
+    body << std::setprecision(std::numeric_limits<float>::max_digits10);
+    body << "o " << scene->mMeshes[mesh]->mName.C_Str() << '\n';
+    body << "usemtl " << scene->mMaterials[scene->mMeshes[mesh]->mMaterialIndex]->GetName().C_Str() << '\n';
+    for (const auto &vertex : vertices)
+    {
+        body << "v " << vertex.position.x << ' ' << vertex.position.y << ' ' << vertex.position.z << '\n';
+        body << "vt " << vertex.uv.x << ' ' << vertex.uv.y << '\n';
+        body << "vn " << vertex.normal.x << ' ' << vertex.normal.y << ' ' << vertex.normal.z << '\n';
+    }
+    for (std::size_t i = 0; i < indices.size(); i += 3)
+    {
+        body << 'f';
+        for (std::size_t k = 0; k < 3; k++)
+        {
+            const std::size_t index = indices[i + k] + vertexOffset;
+            body << ' ' << index << '/' << index << '/' << index;
+        }
+        body << '\n';
+    }
+    vertexOffset += vertices.size();
+}
+} // namespace
+
+std::size_t Deduplicate(std::vector<Vertex> &vertices, std::vector<std::uint32_t> &indices)
+{
+    std::unordered_map<Vertex, std::uint32_t, VertexHash, VertexEqual> unique;
+    unique.reserve(vertices.size());
+
+    std::vector<std::uint32_t> remap(vertices.size());
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+
+    for (std::size_t i = 0; i < vertices.size(); i++)
+    {
+        const auto [it, inserted] = unique.try_emplace(vertices[i], static_cast<std::uint32_t>(result.size()));
+        if (inserted) result.push_back(vertices[i]);
+        remap[i] = it->second;
+    }
+
+    for (auto &index : indices)
+        index = remap[index];
+
+    vertices.swap(result);
+    return vertices.size();
+}
+
+void OptimizeVertexCache(std::vector<std::uint32_t> &indices, const std::size_t vertexCount)
+{
+    const std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // Triangles using each vertex, the first remaining[v] entries of its range are the ones not emitted yet
+    std::vector<std::uint32_t> remaining(vertexCount, 0);
+    for (const auto index : indices)
+        remaining[index]++;
+
+    std::vector<std::uint32_t> offsets(vertexCount + 1, 0);
+    std::inclusive_scan(remaining.begin(), remaining.end(), offsets.begin() + 1);
+
+    std::vector<std::uint32_t> adjacency(indices.size());
+    std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (std::size_t triangle = 0; triangle < triangleCount; triangle++)
+        for (std::size_t k = 0; k < 3; k++)
+            adjacency[fill[indices[triangle * 3 + k]]++] = static_cast<std::uint32_t>(triangle);
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (std::size_t vertex = 0; vertex < vertexCount; vertex++)
+        vertexScore[vertex] = VertexScore(-1, remaining[vertex]);
+
+    std::vector<float> triangleScore(triangleCount);
+    for (std::size_t triangle = 0; triangle < triangleCount; triangle++)
+        triangleScore[triangle] = vertexScore[indices[triangle * 3]] + vertexScore[indices[triangle * 3 + 1]] + vertexScore[indices[triangle * 3 + 2]];
+
+    std::vector<std::uint8_t> emitted(triangleCount, 0);
+    std::vector<std::uint32_t> cache;
+    std::vector<std::uint32_t> newCache;
+    std::vector<std::uint32_t> evicted;
+    cache.reserve(ForsythCacheSize + 3);
+    newCache.reserve(ForsythCacheSize + 3);
+
+    std::vector<std::uint32_t> output;
+    output.reserve(indices.size());
+
+    auto best = static_cast<std::ptrdiff_t>(std::ranges::max_element(triangleScore) - triangleScore.begin());
+    std::size_t scanCursor = 0;
+
+    while (output.size() < triangleCount * 3)
+    {
+        // Nothing left around the cache, continue with the next triangle not emitted yet
+        if (best < 0)
+        {
+            while (emitted[scanCursor])
+                scanCursor++;
+            best = static_cast<std::ptrdiff_t>(scanCursor);
+        }
+
+        const auto triangle = static_cast<std::size_t>(best);
+        emitted[triangle] = 1;
+
+        newCache.clear();
+        for (std::size_t k = 0; k < 3; k++)
+        {
+            const std::uint32_t vertex = indices[triangle * 3 + k];
+            output.push_back(vertex);
+            if (std::ranges::find(newCache, vertex) == newCache.end()) newCache.push_back(vertex);
+
+            const auto first = adjacency.begin() + offsets[vertex];
+            const auto last = first + remaining[vertex];
+            if (const auto it = std::find(first, last, static_cast<std::uint32_t>(triangle)); it != last)
+            {
+                std::iter_swap(it, last - 1);
+                remaining[vertex]--;
+            }
+        }
+
+        for (const auto vertex : cache)
+            if (std::ranges::find(newCache, vertex) == newCache.end()) newCache.push_back(vertex);
+
+        evicted.clear();
+        for (std::size_t i = ForsythCacheSize; i < newCache.size(); i++)
+        {
+            cachePosition[newCache[i]] = -1;
+            evicted.push_back(newCache[i]);
+        }
+        newCache.resize(std::min(newCache.size(), ForsythCacheSize));
+
+        for (std::size_t i = 0; i < newCache.size(); i++)
+            cachePosition[newCache[i]] = static_cast<int>(i);
+
+        const auto rescore = [&](const std::uint32_t vertex) -> void
+        {
+            const float score = VertexScore(cachePosition[vertex], remaining[vertex]);
+            const float delta = score - vertexScore[vertex];
+            vertexScore[vertex] = score;
+            for (std::uint32_t i = 0; i < remaining[vertex]; i++)
+                triangleScore[adjacency[offsets[vertex] + i]] += delta;
+        };
+        for (const auto vertex : newCache)
+            rescore(vertex);
+        for (const auto vertex : evicted)
+            rescore(vertex);
+
+        // Only triangles touching the cache can have the best score
+        best = -1;
+        float bestScore = -std::numeric_limits<float>::max();
+        for (const auto vertex : newCache)
+        {
+            for (std::uint32_t i = 0; i < remaining[vertex]; i++)
+            {
+                const std::uint32_t candidate = adjacency[offsets[vertex] + i];
+                if (triangleScore[candidate] > bestScore)
+                {
+                    bestScore = triangleScore[candidate];
+                    best = candidate;
+                }
+            }
+        }
+
+        cache.swap(newCache);
+    }
+
+    indices.swap(output);
+}
+
+void OptimizeOverdraw(std::vector<std::uint32_t> &indices, const std::vector<Vertex> &vertices, const float threshold)
+{
+    const std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // Split at hard boundaries, triangles where the cache restarted from scratch, moving those clusters around costs nothing
+    constexpr std::uint32_t cacheSize = 16;
+    std::vector<std::uint32_t> timestamps(vertices.size(), 0);
+    std::uint32_t time = cacheSize + 1;
+    std::vector<std::size_t> clusterStarts;
+    for (std::size_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        int misses = 0;
+        for (std::size_t k = 0; k < 3; k++)
+        {
+            const std::uint32_t vertex = indices[triangle * 3 + k];
+            if (time - timestamps[vertex] > cacheSize)
+            {
+                timestamps[vertex] = time++;
+                misses++;
+            }
+        }
+        if (triangle == 0 || misses == 3) clusterStarts.push_back(triangle);
+    }
+    if (clusterStarts.size() < 2) return;
+    clusterStarts.push_back(triangleCount);
+
+    glm::vec3 meshCentroid(0.0f);
+    for (const auto &vertex : vertices)
+        meshCentroid += vertex.position;
+    meshCentroid /= static_cast<float>(vertices.size());
+
+    // Clusters facing away from the mesh center are likely to occlude the rest, draw them first
+    const std::size_t clusterCount = clusterStarts.size() - 1;
+    std::vector<float> sortKeys(clusterCount);
+    for (std::size_t cluster = 0; cluster < clusterCount; cluster++)
+    {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float totalArea = 0.0f;
+        for (std::size_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; triangle++)
+        {
+            const glm::vec3 &a = vertices[indices[triangle * 3]].position;
+            const glm::vec3 &b = vertices[indices[triangle * 3 + 1]].position;
+            const glm::vec3 &c = vertices[indices[triangle * 3 + 2]].position;
+            const glm::vec3 cross = glm::cross(b - a, c - a);
+            const float area = glm::length(cross);
+            centroid += (a + b + c) * (area / 3.0f);
+            normal += cross;
+            totalArea += area;
+        }
+
+        const float normalLength = glm::length(normal);
+        sortKeys[cluster] = totalArea > 0.0f && normalLength > 0.0f
+                                ? glm::dot(centroid / totalArea - meshCentroid, normal / normalLength)
+                                : 0.0f;
+    }
+
+    std::vector<std::size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order, [&](const std::size_t a, const std::size_t b) -> bool { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<std::uint32_t> result;
+    result.reserve(indices.size());
+    for (const auto cluster : order)
+        result.insert(result.end(), indices.begin() + static_cast<std::ptrdiff_t>(clusterStarts[cluster] * 3),
+                      indices.begin() + static_cast<std::ptrdiff_t>(clusterStarts[cluster + 1] * 3));
+
+    // Keep the cache order if the new one costs more vertex shading than the overdraw it may save
+    if (ComputeACMR(result, vertices.size()) <= ComputeACMR(indices, vertices.size()) * threshold)
+        indices.swap(result);
+}
+
+void OptimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<std::uint32_t> &indices)
+{
+    constexpr std::uint32_t unused = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t> remap(vertices.size(), unused);
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+
+    for (auto &index : indices)
+    {
+        if (remap[index] == unused)
+        {
+            remap[index] = static_cast<std::uint32_t>(result.size());
+            result.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(result);
+}
+
+float ComputeACMR(const std::vector<std::uint32_t> &indices, const std::size_t vertexCount, const std::size_t cacheSize)
+{
+    if (indices.size() < 3) return 0.0f;
+
+    // A vertex is in the FIFO while less than cacheSize misses happened after it was loaded
+    std::vector<std::size_t> timestamps(vertexCount, 0);
+    std::size_t time = cacheSize + 1;
+    std::size_t misses = 0;
+    for (const auto index : indices)
+    {
+        if (time - timestamps[index] > cacheSize)
+        {
+            timestamps[index] = time++;
+            misses++;
+        }
+    }
+
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+void SimplifyClustering(std::vector<Vertex> &vertices, std::vector<std::uint32_t> &indices, const int gridResolution)
+{
+    if (vertices.empty() || gridResolution <= 0) return;
+
+    glm::vec3 boundsMin = vertices[0].position;
+    glm::vec3 boundsMax = vertices[0].position;
+    for (const auto &vertex : vertices)
+    {
+        boundsMin = glm::min(boundsMin, vertex.position);
+        boundsMax = glm::max(boundsMax, vertex.position);
+    }
+    const glm::vec3 extent = boundsMax - boundsMin;
+    const float cellSize = std::max({extent.x, extent.y, extent.z, std::numeric_limits<float>::epsilon()}) / static_cast<float>(gridResolution);
+
+    // Every vertex in a cell collapses to the average of the cell
+    std::unordered_map<std::uint64_t, std::uint32_t> cells;
+    std::vector<Vertex> clustered;
+    std::vector<float> counts;
+    std::vector<std::uint32_t> remap(vertices.size());
+    for (std::size_t i = 0; i < vertices.size(); i++)
+    {
+        const glm::vec3 cell = (vertices[i].position - boundsMin) / cellSize;
+        const auto x = static_cast<std::uint64_t>(cell.x);
+        const auto y = static_cast<std::uint64_t>(cell.y);
+        const auto z = static_cast<std::uint64_t>(cell.z);
+        const auto [it, inserted] = cells.try_emplace(x | y << 21 | z << 42, static_cast<std::uint32_t>(clustered.size()));
+        if (inserted)
+        {
+            clustered.push_back({glm::vec3(0.0f), glm::vec3(0.0f), glm::vec2(0.0f)});
+            counts.push_back(0.0f);
+        }
+
+        clustered[it->second].position += vertices[i].position;
+        clustered[it->second].normal += vertices[i].normal;
+        clustered[it->second].uv += vertices[i].uv;
+        counts[it->second] += 1.0f;
+        remap[i] = it->second;
+    }
+
+    for (std::size_t i = 0; i < clustered.size(); i++)
+    {
+        clustered[i].position /= counts[i];
+        clustered[i].uv /= counts[i];
+        if (glm::length(clustered[i].normal) > 0.0f) clustered[i].normal = glm::normalize(clustered[i].normal);
+    }
+
+    std::vector<std::uint32_t> result;
+    result.reserve(indices.size());
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const std::uint32_t a = remap[indices[i]];
+        const std::uint32_t b = remap[indices[i + 1]];
+        const std::uint32_t c = remap[indices[i + 2]];
+        if (a == b || b == c || a == c) continue;
+        result.insert(result.end(), {a, b, c});
+    }
+
+    vertices.swap(clustered);
+    indices.swap(result);
+    OptimizeVertexFetch(vertices, indices);
+}
+
+std::string LodPath(const std::string &source, const int level)
+{
+    const std::filesystem::path path(source);
+    return (path.parent_path() / (path.stem().string() + "_lod" + std::to_string(level) + ".obj")).string();
+}
+
+bool CookLods(const std::string &source, const std::vector<int> &gridResolutions)
+{
+    Assimp::Importer importer;
+    const aiScene *scene = importer.ReadFile(source, aiProcess_Triangulate | aiProcess_GenNormals);
+    if (!scene)
+    {
+        std::cerr << "\033[31mCannot cook LODs of " << source << ": " << importer.GetErrorString() << "\033[0m\n";
+        return false;
+    }
+
+    const std::string materialLibrary = ReadMaterialLibrary(source);
+
+    std::vector<std::vector<Vertex>> meshVertices(scene->mNumMeshes);
+    std::vector<std::vector<std::uint32_t>> meshIndices(scene->mNumMeshes);
+    std::size_t sourceTriangles = 0;
+    float radius = 0.0f;
+    for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+    {
+        ReadMesh(scene->mMeshes[m], meshVertices[m], meshIndices[m]);
+        for (const auto &vertex : meshVertices[m])
+            radius = std::max(radius, glm::length(vertex.position));
+        sourceTriangles += meshIndices[m].size() / 3;
+    }
+
+    for (std::size_t level = 0; level < gridResolutions.size(); level++)
+    {
+        std::ostringstream body;
+        std::size_t triangles = 0;
+        std::size_t vertexOffset = 1;
+        for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+        {
+            std::vector<Vertex> vertices = meshVertices[m];
+            std::vector<std::uint32_t> indices = meshIndices[m];
+            SimplifyClustering(vertices, indices, gridResolutions[level]);
+            OptimizeVertexCache(indices, vertices.size());
+            if (indices.empty()) continue;
+
+            WriteObjMesh(body, scene, m, vertices, indices, vertexOffset);
+            triangles += indices.size() / 3;
+        }
+
+        std::ofstream output(LodPath(source, static_cast<int>(level + 1)));
+        if (!output.is_open()) return false;
+        output << "# lod " << level + 1 << " source_triangles " << sourceTriangles << " triangles " << triangles << " radius " << radius << '\n';
+        if (!materialLibrary.empty()) output << materialLibrary << '\n';
+        output << body.str();
+    }
+
+    return true;
+}
+
+std::optional<LodInfo> ReadLodInfo(const std::string &path)
+{
+    std::ifstream stream(path);
+    if (!stream.is_open()) return std::nullopt;
+
+    std::string comment, lod, sourceLabel, trianglesLabel, radiusLabel;
+    int level = 0;
+    LodInfo info;
+    stream >> comment >> lod >> level >> sourceLabel >> info.sourceTriangles >> trianglesLabel >> info.triangles >> radiusLabel >> info.radius;
+    if (!stream || comment != "#" || lod != "lod") return std::nullopt;
+    return info;
+}
+
+std::string OptimizedPath(const std::string &source)
+{
+    const std::filesystem::path path(source);
+    return (path.parent_path() / (path.stem().string() + "_opt.obj")).string();
+}
+
+std::string CookOptimized(const std::string &source)
+{
+    if (std::filesystem::path(source).extension() != ".obj") return source;
+
+    const std::string cooked = OptimizedPath(source);
+    std::error_code error;
+    const auto sourceTime = std::filesystem::last_write_time(source, error);
+    if (error) return source;
+    if (std::filesystem::exists(cooked) && std::filesystem::last_write_time(cooked, error) >= sourceTime) return cooked;
+
+    Assimp::Importer importer;
+    const aiScene *scene = importer.ReadFile(source, aiProcess_Triangulate | aiProcess_GenNormals);
+    if (!scene)
+    {
+        std::cerr << "\033[31mCannot optimize " << source << ": " << importer.GetErrorString() << "\033[0m\n";
+        return source;
+    }
+
+    std::cout << "Optimizing " << source << '\n';
+    std::ostringstream body;
+    std::size_t vertexOffset = 1;
+    std::size_t triangles = 0;
+    std::vector<Vertex> vertices;
+    std::vector<std::uint32_t> indices;
+    for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+    {
+        ReadMesh(scene->mMeshes[m], vertices, indices);
+        Deduplicate(vertices, indices);
+        OptimizeVertexCache(indices, vertices.size());
+        OptimizeOverdraw(indices, vertices);
+        OptimizeVertexFetch(vertices, indices);
+        if (indices.empty()) continue;
+        WriteObjMesh(body, scene, m, vertices, indices, vertexOffset);
+        triangles += indices.size() / 3;
+    }
+
+    std::ofstream output(cooked);
+    if (!output.is_open()) return source;
+    output << "# optimized triangles " << triangles << '\n';
+    if (const std::string materialLibrary = ReadMaterialLibrary(source); !materialLibrary.empty()) output << materialLibrary << '\n';
+    output << body.str();
+    return cooked;
+}
+
+std::size_t CountTriangles(const std::string &path)
+{
+    // The optimised copies carry the count in their first line
+    std::ifstream stream(path);
+    std::string comment, label, trianglesLabel;
+    std::size_t triangles = 0;
+    if (stream >> comment >> label >> trianglesLabel >> triangles && comment == "#" && label == "optimized" && trianglesLabel == "triangles")
+        return triangles;
+
+    Assimp::Importer importer;
+    const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate);
+    if (!scene) return 0;
+    triangles = 0;
+    for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+        triangles += scene->mMeshes[m]->mNumFaces;
+    return triangles;
+}
+
+MeshReport AnalyzeModel(const std::string &path)
+{
+    MeshReport report{.name = path};
+
+    // The source as exported against the file the game actually loads, measured as they are
+    const std::string loaded = std::filesystem::path(path).extension() == ".obj" ? OptimizedPath(path) : path;
+    for (auto [file, stats] : {std::pair{&path, &report.before}, std::pair{&loaded, &report.after}})
+    {
+        Assimp::Importer importer;
+        const aiScene *scene = importer.ReadFile(*file, aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_JoinIdenticalVertices);
+        if (!scene)
+        {
+            std::cerr << "\033[31mCannot analyze " << *file << ": " << importer.GetErrorString() << "\033[0m\n";
+            return report;
+        }
+
+        float acmr = 0.0f;
+        std::vector<Vertex> vertices;
+        std::vector<std::uint32_t> indices;
+        for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+        {
+            ReadMesh(scene->mMeshes[m], vertices, indices);
+            const MeshStats meshStats = Measure(indices, vertices.size(), sizeof(Vertex));
+            stats->vertices += meshStats.vertices;
+            stats->triangles += meshStats.triangles;
+            stats->vertexBytes += meshStats.vertexBytes;
+            acmr += meshStats.acmr * static_cast<float>(meshStats.triangles);
+        }
+        if (stats->triangles > 0) stats->acmr = acmr / static_cast<float>(stats->triangles);
+    }
+    return report;
+}
+} // namespace MeshOptimizer
@@ -0,0 +1,89 @@
+#ifndef PROYECTOFINAL_CGA_MESHOPTIMIZER_H
+#define PROYECTOFINAL_CGA_MESHOPTIMIZER_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Import time mesh optimisation: vertex deduplication, post transform cache
+ * ordering (Forsyth), overdraw ordering and fetch ordering, written to a
+ * cooked OBJ the engine loads as is. Also cooks simplified LOD files.
+ */
+namespace MeshOptimizer
+{
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+};
+
+struct MeshStats
+{
+    std::size_t vertices = 0;
+    std::size_t triangles = 0;
+    float acmr = 0.0f;
+    /// At sizeof(Vertex) for both copies, the layout is the same and only the vertex count changes.
+    std::size_t vertexBytes = 0;
+};
+
+struct MeshReport
+{
+    std::string name;
+    MeshStats before;
+    MeshStats after;
+};
+
+/// Merges bit identical vertices and rewrites the indices, returns the new vertex count.
+std::size_t Deduplicate(std::vector<Vertex> &vertices, std::vector<std::uint32_t> &indices);
+
+/// Reorders the triangles for the post transform vertex cache (Tom Forsyth's linear speed algorithm).
+void OptimizeVertexCache(std::vector<std::uint32_t> &indices, std::size_t vertexCount);
+
+/// Reorders cache friendly clusters of triangles outside in, keeping the ACMR within the threshold.
+void OptimizeOverdraw(std::vector<std::uint32_t> &indices, const std::vector<Vertex> &vertices, float threshold = 1.05f);
+
+/// Reorders the vertices in the order the indices first use them.
+void OptimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<std::uint32_t> &indices);
+
+/// Average cache miss ratio, transformed vertices per triangle with a FIFO cache.
+float ComputeACMR(const std::vector<std::uint32_t> &indices, std::size_t vertexCount, std::size_t cacheSize = 16);
+
+/// Header of a cooked LOD file.
+struct LodInfo
+{
+    std::size_t sourceTriangles = 0;
+    std::size_t triangles = 0;
+    float radius = 0.0f;
+};
+
+/// Vertex clustering, snaps the vertices to a grid with gridResolution cells along the largest axis and drops the collapsed triangles.
+void SimplifyClustering(std::vector<Vertex> &vertices, std::vector<std::uint32_t> &indices, int gridResolution);
+
+/// Cooked file of the given level, <stem>_lod<level>.obj next to the source.
+std::string LodPath(const std::string &source, int level);
+
+/// Writes one simplified OBJ per grid resolution (level 1, 2...), keeping the source materials.
+bool CookLods(const std::string &source, const std::vector<int> &gridResolutions);
+
+std::optional<LodInfo> ReadLodInfo(const std::string &path);
+
+/// Cooked copy of a model with every stage applied, <stem>_opt.obj next to the source.
+std::string OptimizedPath(const std::string &source);
+
+/// Writes the optimised copy of an OBJ when it is missing or older than the source, returns the file to load (the source if it cannot be cooked).
+std::string CookOptimized(const std::string &source);
+
+/// Triangles of a model file, read from the header of an optimised copy or counted after an import.
+std::size_t CountTriangles(const std::string &path);
+
+/// Measures the source and the optimised copy the game loads, one entry for the whole model.
+MeshReport AnalyzeModel(const std::string &path);
+} // namespace MeshOptimizer
+
+#endif // PROYECTOFINAL_CGA_MESHOPTIMIZER_H
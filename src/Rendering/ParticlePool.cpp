@@ -0,0 +1,110 @@
+#include "ParticlePool.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+ParticlePool::ParticlePool(const std::size_t maxParticles)
+    : capacity(maxParticles)
+{
+    // The SIMD loops always process whole groups of four
+    const std::size_t padded = (maxParticles + 3) & ~static_cast<std::size_t>(3);
+    for (auto *array : {&positionX, &positionY, &positionZ, &velocityX, &velocityY, &velocityZ, &life, &inverseLifetime, &gravity, &size, &stretch,
+                        &colorR, &colorG, &colorB, &colorA})
+        array->assign(padded, 0.0f);
+}
+
+bool ParticlePool::Emit(const ParticleSpawn &spawn)
+{
+    if (count == capacity) return false;
+
+    const std::size_t i = count++;
+    positionX[i] = spawn.position.x;
+    positionY[i] = spawn.position.y;
+    positionZ[i] = spawn.position.z;
+    velocityX[i] = spawn.velocity.x;
+    velocityY[i] = spawn.velocity.y;
+    velocityZ[i] = spawn.velocity.z;
+    life[i] = spawn.lifetime;
+    inverseLifetime[i] = spawn.lifetime > 0.0f ? 1.0f / spawn.lifetime : 0.0f;
+    gravity[i] = spawn.gravity;
+    size[i] = spawn.size;
+    stretch[i] = spawn.stretch;
+    colorR[i] = spawn.color.x;
+    colorG[i] = spawn.color.y;
+    colorB[i] = spawn.color.z;
+    colorA[i] = spawn.color.w;
+    return true;
+}
+
+void ParticlePool::Simulate(const float deltaTime, const glm::vec3 &worldVelocity)
+{
+    const std::size_t groups = (count + 3) & ~static_cast<std::size_t>(3);
+    float *px = positionX.data(), *py = positionY.data(), *pz = positionZ.data();
+    float *vx = velocityX.data(), *vy = velocityY.data(), *vz = velocityZ.data();
+    float *l = life.data();
+    const float *g = gravity.data();
+
+#if defined(__SSE__)
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 worldX = _mm_set1_ps(worldVelocity.x);
+    const __m128 worldY = _mm_set1_ps(worldVelocity.y);
+    const __m128 worldZ = _mm_set1_ps(worldVelocity.z);
+    for (std::size_t i = 0; i < groups; i += 4)
+    {
+        const __m128 velocityYi = _mm_add_ps(_mm_loadu_ps(vy + i), _mm_mul_ps(_mm_loadu_ps(g + i), dt));
+        _mm_storeu_ps(vy + i, velocityYi);
+        _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vx + i), worldX), dt)));
+        _mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(_mm_add_ps(velocityYi, worldY), dt)));
+        _mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vz + i), worldZ), dt)));
+        _mm_storeu_ps(l + i, _mm_sub_ps(_mm_loadu_ps(l + i), dt));
+    }
+#else
+    for (std::size_t i = 0; i < groups; i++)
+    {
+        vy[i] += g[i] * deltaTime;
+        px[i] += (vx[i] + worldVelocity.x) * deltaTime;
+        py[i] += (vy[i] + worldVelocity.y) * deltaTime;
+        pz[i] += (vz[i] + worldVelocity.z) * deltaTime;
+        l[i] -= deltaTime;
+    }
+#endif
+
+    for (std::size_t i = 0; i < count;)
+    {
+        if (l[i] > 0.0f)
+        {
+            i++;
+            continue;
+        }
+        Move(--count, i);
+    }
+}
+
+void ParticlePool::Move(const std::size_t from, const std::size_t to)
+{
+    for (auto *array : {&positionX, &positionY, &positionZ, &velocityX, &velocityY, &velocityZ, &life, &inverseLifetime, &gravity, &size, &stretch,
+                        &colorR, &colorG, &colorB, &colorA})
+        (*array)[to] = (*array)[from];
+}
+
+void ParticlePool::Pack(std::vector<ParticleInstance> &instances, const glm::vec3 &worldVelocity) const
+{
+    instances.resize(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        // 1 when spawned, 0 when it expires
+        const float remaining = life[i] * inverseLifetime[i];
+        instances[i] = {
+            .positionSize = {positionX[i], positionY[i], positionZ[i], size[i] * (0.5f + 0.5f * remaining)},
+            .color = {colorR[i], colorG[i], colorB[i], colorA[i] * remaining},
+            .velocityStretch = {velocityX[i] + worldVelocity.x, velocityY[i] + worldVelocity.y, velocityZ[i] + worldVelocity.z, stretch[i]},
+        };
+    }
+}
+
+void ParticlePool::Clear() { count = 0; }
+
+std::size_t ParticlePool::Size() const { return count; }
+
+std::size_t ParticlePool::Capacity() const { return capacity; }
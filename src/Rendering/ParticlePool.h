@@ -0,0 +1,76 @@
+#ifndef PROYECTOFINAL_CGA_PARTICLEPOOL_H
+#define PROYECTOFINAL_CGA_PARTICLEPOOL_H
+
+#include "../Services/MemoryTracker.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+struct ParticleSpawn
+{
+    glm::vec3 position{0.0f};
+    glm::vec3 velocity{0.0f};
+    glm::vec4 color{1.0f};
+    float lifetime = 1.0f;
+    float size = 0.1f;
+    float gravity = 0.0f;
+    /// Billboard length per unit of speed, 0 draws a square.
+    float stretch = 0.0f;
+};
+
+/// Per instance data of the billboard draw, matches the attributes of particle.vert.
+struct ParticleInstance
+{
+    glm::vec4 positionSize;
+    glm::vec4 color;
+    glm::vec4 velocityStretch;
+};
+
+/**
+ * Fixed capacity particle storage in structure of arrays layout.
+ *
+ * Every attribute lives in its own float array padded to a multiple of four,
+ * so the integration runs four particles per SSE instruction with no tail
+ * loop. Dead particles are replaced by the last live one, the live range is
+ * always [0, Size()).
+ */
+class ParticlePool
+{
+    std::size_t capacity = 0;
+    std::size_t count = 0;
+
+    using Stream = std::vector<float, TaggedAllocator<float, MemoryTag::Particles>>;
+
+    Stream positionX, positionY, positionZ;
+    Stream velocityX, velocityY, velocityZ;
+    Stream life, inverseLifetime;
+    Stream gravity;
+    Stream size, stretch;
+    Stream colorR, colorG, colorB, colorA;
+
+    void Move(std::size_t from, std::size_t to);
+
+  public:
+    ParticlePool() = default;
+
+    explicit ParticlePool(std::size_t maxParticles);
+
+    /// Returns false when the pool is full, the particle is dropped.
+    bool Emit(const ParticleSpawn &spawn);
+
+    /// Integrates every particle and removes the expired ones. The world velocity is added to all of them (scrolling road).
+    void Simulate(float deltaTime, const glm::vec3 &worldVelocity = glm::vec3(0.0f));
+
+    /// Writes the live particles as billboard instances, fading alpha and size over their life.
+    void Pack(std::vector<ParticleInstance> &instances, const glm::vec3 &worldVelocity = glm::vec3(0.0f)) const;
+
+    void Clear();
+
+    [[nodiscard]] std::size_t Size() const;
+
+    [[nodiscard]] std::size_t Capacity() const;
+};
+
+#endif // PROYECTOFINAL_CGA_PARTICLEPOOL_H
@@ -0,0 +1,177 @@
+#include "GlobalDefines.h"
+
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+std::uint16_t RenderQueue::GetId(const void *resource)
+{
+    if (resource == nullptr) return 0;
+    const auto [it, inserted] = resourceIds.try_emplace(resource, static_cast<std::uint16_t>(resourceIds.size() + 1));
+    return it->second;
+}
+
+std::uint64_t RenderQueue::MakeKey(const RenderPass pass, const Shader *shader, const bool skinned, const Model *model, const float depth)
+{
+    const auto passBits = static_cast<std::uint64_t>(pass) & 0xF;
+    // The lowest shader bit splits the static and skinned variants
+    const std::uint64_t shaderBits = (static_cast<std::uint64_t>(GetId(shader)) << 1 | (skinned ? 1 : 0)) & 0xFFF;
+    // Models carry their own materials and bind them while drawing, the model is the only state after the shader
+    const std::uint64_t modelBits = GetId(model) & 0xFFFF;
+    const auto depthBits = static_cast<std::uint64_t>(std::clamp(depth / maxDepth, 0.0f, 1.0f) * static_cast<float>(0xFFFFF));
+
+    // Depth only orders the draws that share shader and model
+    if (pass == RenderPass::Opaque || pass == RenderPass::Skybox)
+        return passBits << 60 | shaderBits << 48 | modelBits << 32 | depthBits;
+
+    // Blended passes are drawn back to front, depth goes first and inverted
+    return passBits << 60 | (0xFFFFF - depthBits) << 40 | shaderBits << 28 | modelBits << 12;
+}
+
+RenderQueue::ShaderState &RenderQueue::GetShaderState(Shader &shader)
+{
+    auto [it, inserted] = shaderStates.try_emplace(&shader);
+    if (inserted)
+    {
+        it->second.model = shader.GetUniformLocation("model");
+        it->second.bones.resize(MAX_BONES);
+        for (int i = 0; i < MAX_BONES; i++)
+            it->second.bones[i] = shader.GetUniformLocation(std::format("bones[{}]", i).c_str());
+    }
+    return it->second;
+}
+
+unsigned int RenderQueue::GetVariant(const RenderCommand &command) const
+{
+    const auto it = shaderVariants.find(command.shader);
+    if (it == shaderVariants.end()) return 0;
+    return it->second[command.bones != nullptr ? 1 : 0];
+}
+
+RenderQueue::RenderQueue(FrameArena &frameArena)
+    : arena(&frameArena), commands(ArenaAllocator<RenderCommand>(frameArena)), sortBuffer(ArenaAllocator<RenderCommand>(frameArena))
+{
+}
+
+void RenderQueue::Begin(const glm::vec3 &camera, const float farPlane)
+{
+    cameraPosition = camera;
+    maxDepth = farPlane;
+    // The last lists were released by the arena's Reset, a steady frame never grows the new one
+    commands = FrameVector<RenderCommand>(ArenaAllocator<RenderCommand>(*arena));
+    commands.reserve(lastFrameCommands);
+    sortBuffer = FrameVector<RenderCommand>(ArenaAllocator<RenderCommand>(*arena));
+}
+
+void RenderQueue::Submit(const RenderPass pass, Shader &shader, Model &model, const glm::mat4 &transform, const glm::mat4 *bones, const std::uint32_t boneCount)
+{
+    const float depth = glm::length(glm::vec3(transform[3]) - cameraPosition);
+    commands.push_back({
+        .key = MakeKey(pass, &shader, bones != nullptr, &model, depth),
+        .shader = &shader,
+        .model = &model,
+        .transform = transform,
+        .bones = bones,
+        .boneCount = boneCount,
+    });
+}
+
+void RenderQueue::SubmitCustom(const RenderPass pass, const RenderCallback callback, void *userData, const float depth)
+{
+    commands.push_back({
+        .key = MakeKey(pass, nullptr, false, nullptr, depth),
+        .callback = callback,
+        .userData = userData,
+    });
+}
+
+void RenderQueue::RadixSort()
+{
+    // LSD radix sort on the 64 bit keys, one byte per pass, stable so equal keys keep the submission order
+    sortBuffer.resize(commands.size());
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        std::array<std::size_t, 256> histogram{};
+        for (const auto &command : commands)
+            histogram[(command.key >> shift) & 0xFF]++;
+
+        // Every key has the same byte here, nothing to reorder
+        if (std::ranges::find(histogram, commands.size()) != histogram.end()) continue;
+
+        std::size_t offset = 0;
+        for (auto &count : histogram)
+            offset += std::exchange(count, offset);
+
+        for (const auto &command : commands)
+            sortBuffer[histogram[(command.key >> shift) & 0xFF]++] = command;
+
+        commands.swap(sortBuffer);
+    }
+}
+
+void RenderQueue::Execute()
+{
+    stats = {.commands = static_cast<std::uint32_t>(commands.size())};
+    lastFrameCommands = commands.size();
+    RadixSort();
+
+    const Shader *boundShader = nullptr;
+    unsigned int boundProgram = 0;
+    const Model *lastModel = nullptr;
+    for (const auto &command : commands)
+    {
+        if (command.callback)
+        {
+            command.callback(command.userData);
+            // Custom draws bind their own shaders
+            boundShader = nullptr;
+            continue;
+        }
+
+        const unsigned int program = GetVariant(command);
+        if (command.shader != boundShader || program != boundProgram)
+        {
+            command.shader->Use();
+            // Same uniform locations, the engine Shader keeps setting them on the bound variant
+            if (program != 0) glUseProgram(program);
+            boundShader = command.shader;
+            boundProgram = program;
+            stats.shaderBinds++;
+        }
+        else
+            stats.redundantBindsSkipped++;
+        if (program != 0) stats.variantDraws++;
+
+        if (command.model != lastModel)
+        {
+            lastModel = command.model;
+            stats.modelChanges++;
+        }
+
+        auto &state = GetShaderState(*command.shader);
+        command.shader->Set<4, 4>(state.model, command.transform);
+        for (std::uint32_t i = 0; i < command.boneCount; i++)
+            command.shader->Set<4, 4>(state.bones[i], command.bones[i]);
+
+        command.model->Render(*command.shader);
+
+        for (std::uint32_t i = 0; i < command.boneCount; i++)
+            command.shader->Set<4, 4>(state.bones[i], glm::mat4(1.0f));
+    }
+
+    commands.clear();
+}
+
+void RenderQueue::SetVariants(const Shader &shader, const unsigned int staticProgram, const unsigned int skinnedProgram)
+{
+    if (staticProgram == 0 && skinnedProgram == 0)
+        shaderVariants.erase(&shader);
+    else
+        shaderVariants[&shader] = {staticProgram, skinnedProgram};
+}
+
+void RenderQueue::ResetShaderCache() { shaderStates.clear(); }
+
+const RenderQueueStats &RenderQueue::GetStats() const { return stats; }
@@ -0,0 +1,115 @@
+#ifndef PROYECTOFINAL_CGA_RENDERQUEUE_H
+#define PROYECTOFINAL_CGA_RENDERQUEUE_H
+
+#include "../Services/FrameArena.h"
+#include "Model.h"
+#include "Shader.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+enum class RenderPass : std::uint8_t
+{
+    Skybox = 0,
+    Opaque = 1,
+    Transparent = 2,
+    Debug = 3
+};
+
+using RenderCallback = void (*)(void *userData);
+
+struct RenderCommand
+{
+    std::uint64_t key = 0;
+    Shader *shader = nullptr;
+    Model *model = nullptr;
+    glm::mat4 transform{1.0f};
+    const glm::mat4 *bones = nullptr;
+    std::uint32_t boneCount = 0;
+    RenderCallback callback = nullptr;
+    void *userData = nullptr;
+};
+
+struct RenderQueueStats
+{
+    std::uint32_t commands = 0;
+    std::uint32_t shaderBinds = 0;
+    std::uint32_t redundantBindsSkipped = 0;
+    std::uint32_t modelChanges = 0;
+    std::uint32_t variantDraws = 0;
+};
+
+/**
+ * Frame local list of draw commands.
+ *
+ * Every draw of the main view is submitted here with a 64 bit sort key
+ * (pass | shader | model | depth), sorted with a radix sort and executed in
+ * one place, binding each shader only when it actually changes. Opaque
+ * commands are sorted by state, front to back only among the draws of the
+ * same shader and model; the blended passes are sorted back to front first.
+ * Models bind their own materials, one id stands for the material and the mesh.
+ * A shader may be replaced by compiled variants, the static or skinned one is
+ * picked per command.
+ *
+ * The commands live in the frame arena, each Begin starts new lists in it
+ * sized for the previous frame, so the queue keeps nothing between frames.
+ */
+class RenderQueue
+{
+    struct ShaderState
+    {
+        GLint model = -1;
+        std::vector<GLint> bones;
+    };
+
+    FrameArena *arena;
+    FrameVector<RenderCommand> commands;
+    FrameVector<RenderCommand> sortBuffer;
+    std::size_t lastFrameCommands = 0;
+    std::unordered_map<const void *, std::uint16_t> resourceIds;
+    std::unordered_map<const Shader *, ShaderState> shaderStates;
+    std::unordered_map<const Shader *, std::array<unsigned int, 2>> shaderVariants;
+    glm::vec3 cameraPosition{0.0f};
+    float maxDepth = 100.0f;
+    RenderQueueStats stats{};
+
+    std::uint16_t GetId(const void *resource);
+
+    std::uint64_t MakeKey(RenderPass pass, const Shader *shader, bool skinned, const Model *model, float depth);
+
+    [[nodiscard]] unsigned int GetVariant(const RenderCommand &command) const;
+
+    ShaderState &GetShaderState(Shader &shader);
+
+    void RadixSort();
+
+  public:
+    /// The arena must be reset between Execute and the next Begin, not in the middle of a frame.
+    explicit RenderQueue(FrameArena &frameArena);
+
+    /// Starts a new frame, the camera position is used to sort by depth.
+    void Begin(const glm::vec3 &camera, float farPlane);
+
+    void Submit(RenderPass pass, Shader &shader, Model &model, const glm::mat4 &transform, const glm::mat4 *bones = nullptr, std::uint32_t boneCount = 0);
+
+    /// Submits a draw that is not a Model (skybox, grid, debug geometry). The callback may bind other shaders.
+    void SubmitCustom(RenderPass pass, RenderCallback callback, void *userData, float depth = 0.0f);
+
+    /// Sorts and draws every submitted command, then clears the queue.
+    void Execute();
+
+    /// Draws the shader's commands with these programs (0 keeps the shader). They must share its uniform locations.
+    void SetVariants(const Shader &shader, unsigned int staticProgram, unsigned int skinnedProgram);
+
+    /// Forgets the cached uniform locations, needed after a shader is relinked.
+    void ResetShaderCache();
+
+    [[nodiscard]] const RenderQueueStats &GetStats() const;
+};
+
+#endif // PROYECTOFINAL_CGA_RENDERQUEUE_H
@@ -0,0 +1,250 @@
+#include "GlobalDefines.h"
+
+#include "ShaderVariantCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+ShaderVariantCache::~ShaderVariantCache()
+{
+    for (const auto &[key, program] : programs)
+        if (program != 0) glDeleteProgram(program);
+}
+
+std::uint64_t ShaderVariantCache::Hash(const std::string &data, std::uint64_t seed)
+{
+    // FNV-1a, stable between runs unlike std::hash
+    for (const char c : data)
+    {
+        seed ^= static_cast<unsigned char>(c);
+        seed *= 1099511628211ull;
+    }
+    return seed;
+}
+
+std::string ShaderVariantCache::InjectDefines(const std::string &source, const std::vector<std::string> &defines)
+{
+    std::string header = "#define SHADER_VARIANT\n";
+    for (const auto &define : defines)
+        header += "#define " + define + '\n';
+
+    // The defines must go after #version, #line keeps the compiler errors on the original lines
+    const std::size_t version = source.find("#version");
+    const std::size_t lineEnd = version == std::string::npos ? std::string::npos : source.find('\n', version);
+    if (lineEnd == std::string::npos) return header + source;
+    return source.substr(0, lineEnd + 1) + header + "#line 2\n" + source.substr(lineEnd + 1);
+}
+
+void ShaderVariantCache::Init(const std::filesystem::path &shaders, const std::filesystem::path &cache)
+{
+    shadersDirectory = shaders;
+    cacheDirectory = cache;
+
+    for (const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    {
+        const auto *value = reinterpret_cast<const char *>(glGetString(name));
+        driver += value ? value : "";
+        driver += '\n';
+    }
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    binarySupported = formats > 0;
+    if (!binarySupported)
+        std::cout << "\033[33mThe driver has no program binary formats, shader variants will not be cached.\033[0m\n";
+
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory, error);
+}
+
+unsigned int ShaderVariantCache::LoadBinary(const std::filesystem::path &path, const std::uint64_t sourceHash) const
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return 0;
+
+    std::uint64_t storedHash = 0;
+    std::uint32_t format = 0;
+    file.read(reinterpret_cast<char *>(&storedHash), sizeof(storedHash));
+    file.read(reinterpret_cast<char *>(&format), sizeof(format));
+    if (!file || storedHash != sourceHash) return 0;
+
+    const std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const GLuint program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    // The driver may reject a binary it wrote itself (e.g. after an update with the same version string)
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked == GL_TRUE) return program;
+
+    glDeleteProgram(program);
+    return 0;
+}
+
+void ShaderVariantCache::SaveBinary(const std::filesystem::path &path, const std::uint64_t sourceHash, const unsigned int program) const
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(static_cast<std::size_t>(length));
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return;
+    const auto storedFormat = static_cast<std::uint32_t>(format);
+    file.write(reinterpret_cast<const char *>(&sourceHash), sizeof(sourceHash));
+    file.write(reinterpret_cast<const char *>(&storedFormat), sizeof(storedFormat));
+    file.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+}
+
+unsigned int ShaderVariantCache::Compile(const std::string &name, const Sources &stages) const
+{
+    const GLuint program = glCreateProgram();
+    std::vector<GLuint> shaders;
+    bool compiled = true;
+    for (const auto &[type, source] : stages)
+    {
+        const GLuint shader = glCreateShader(type);
+        const char *code = source.c_str();
+        glShaderSource(shader, 1, &code, nullptr);
+        glCompileShader(shader);
+
+        GLint status = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+        if (status != GL_TRUE)
+        {
+            std::array<char, 1024> log{};
+            glGetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), nullptr, log.data());
+            std::cerr << "\033[31mCannot compile a variant of " << name << ":\n" << log.data() << "\033[0m\n";
+            compiled = false;
+        }
+        glAttachShader(program, shader);
+        shaders.push_back(shader);
+    }
+
+    GLint linked = GL_FALSE;
+    if (compiled)
+    {
+        if (binarySupported) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(program);
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked != GL_TRUE)
+        {
+            std::array<char, 1024> log{};
+            glGetProgramInfoLog(program, static_cast<GLsizei>(log.size()), nullptr, log.data());
+            std::cerr << "\033[31mCannot link a variant of " << name << ":\n" << log.data() << "\033[0m\n";
+        }
+    }
+
+    for (const GLuint shader : shaders)
+    {
+        glDetachShader(program, shader);
+        glDeleteShader(shader);
+    }
+
+    if (linked == GL_TRUE) return program;
+    glDeleteProgram(program);
+    return 0;
+}
+
+unsigned int ShaderVariantCache::Get(const std::string &name, const std::vector<std::string> &defines)
+{
+    std::string key = name + '\n';
+    for (const auto &define : defines)
+        key += define + '\n';
+    if (const auto it = programs.find(key); it != programs.end()) return it->second;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    auto shaderSources = sources.find(name);
+    if (shaderSources == sources.end()) shaderSources = sources.emplace(name, ReadSources(shadersDirectory, name)).first;
+
+    Sources stages;
+    std::uint64_t sourceHash = Hash(driver);
+    for (const auto &[type, source] : shaderSources->second)
+    {
+        stages.emplace_back(type, InjectDefines(source, defines));
+        sourceHash = Hash(stages.back().second, sourceHash);
+    }
+
+    GLuint program = 0;
+    if (!stages.empty())
+    {
+        // One file per variant, a stale hash is overwritten instead of piling up
+        const std::filesystem::path binaryPath = cacheDirectory / std::format("{}-{:016x}.bin", name, Hash(key));
+        if (binarySupported) program = LoadBinary(binaryPath, sourceHash);
+
+        if (program != 0)
+            stats.loadedFromCache++;
+        else if ((program = Compile(name, stages)) != 0)
+        {
+            stats.compiled++;
+            if (binarySupported) SaveBinary(binaryPath, sourceHash, program);
+        }
+    }
+    else
+        std::cerr << "\033[31mNo sources for the shader " << name << " in " << shadersDirectory << "\033[0m\n";
+
+    stats.milliseconds += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    programs[key] = program;
+    return program;
+}
+
+ShaderVariantCache::Sources ShaderVariantCache::ReadSources(const std::filesystem::path &directory, const std::string &name)
+{
+    constexpr std::array<std::pair<GLenum, const char *>, 3> stageFiles = {
+        {{GL_VERTEX_SHADER, ".vert"}, {GL_GEOMETRY_SHADER, ".geom"}, {GL_FRAGMENT_SHADER, ".frag"}}
+    };
+    Sources shaderSources;
+    for (const auto &[type, extension] : stageFiles)
+    {
+        std::ifstream file(directory / (name + extension));
+        if (!file.is_open()) continue;
+        std::stringstream source;
+        source << file.rdbuf();
+        shaderSources.emplace_back(type, source.str());
+    }
+    return shaderSources;
+}
+
+void ShaderVariantCache::Invalidate(const std::string &name, Sources shaderSources)
+{
+    sources[name] = std::move(shaderSources);
+    version++;
+    const std::string prefix = name + '\n';
+    for (auto it = programs.begin(); it != programs.end();)
+    {
+        if (it->first.compare(0, prefix.size(), prefix) != 0)
+        {
+            ++it;
+            continue;
+        }
+        if (it->second != 0) glDeleteProgram(it->second);
+        it = programs.erase(it);
+    }
+}
+
+std::uint32_t ShaderVariantCache::GetVersion() const { return version; }
+
+void ShaderVariantCache::SetUniform(const unsigned int program, const int location, const int value) { glProgramUniform1i(program, location, value); }
+
+void ShaderVariantCache::SetUniform(const unsigned int program, const int location, const float value) { glProgramUniform1f(program, location, value); }
+
+void ShaderVariantCache::SetUniform(const unsigned int program, const int location, const glm::vec3 &value)
+{
+    glProgramUniform3fv(program, location, 1, glm::value_ptr(value));
+}
+
+void ShaderVariantCache::SetUniform(const unsigned int program, const int location, const glm::mat4 &value)
+{
+    glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+const ShaderVariantStats &ShaderVariantCache::GetStats() const { return stats; }
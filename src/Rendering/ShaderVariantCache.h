@@ -0,0 +1,94 @@
+#ifndef PROYECTOFINAL_CGA_SHADERVARIANTCACHE_H
+#define PROYECTOFINAL_CGA_SHADERVARIANTCACHE_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct ShaderVariantStats
+{
+    int compiled = 0;
+    int loadedFromCache = 0;
+    float milliseconds = 0.0f;
+};
+
+/**
+ * Compiles permutations of a shader from sets of #define lines.
+ *
+ * Every variant gets SHADER_VARIANT plus its defines injected after the
+ * #version line. Linked programs are saved with glGetProgramBinary and loaded
+ * back on the next launch, keyed by the driver strings and the hash of the
+ * preprocessed sources, so a driver update or an edited shader recompiles.
+ * Programs are raw GL handles, the shaders must declare explicit uniform
+ * locations. Their uniforms are set with the SetUniform functions, which
+ * write to a program without binding it.
+ */
+class ShaderVariantCache
+{
+  public:
+    /// Stage type and source of every file of a shader.
+    using Sources = std::vector<std::pair<unsigned int, std::string>>;
+
+  private:
+    std::filesystem::path shadersDirectory;
+    std::filesystem::path cacheDirectory;
+    std::string driver;
+    bool binarySupported = false;
+    std::unordered_map<std::string, unsigned int> programs;
+    // Read once per shader and shared by its variants
+    std::unordered_map<std::string, Sources> sources;
+    std::uint32_t version = 0;
+    ShaderVariantStats stats{};
+
+    static std::uint64_t Hash(const std::string &data, std::uint64_t seed = 14695981039346656037ull);
+
+    static std::string InjectDefines(const std::string &source, const std::vector<std::string> &defines);
+
+    unsigned int LoadBinary(const std::filesystem::path &path, std::uint64_t sourceHash) const;
+
+    void SaveBinary(const std::filesystem::path &path, std::uint64_t sourceHash, unsigned int program) const;
+
+    unsigned int Compile(const std::string &name, const Sources &stages) const;
+
+  public:
+    ShaderVariantCache() = default;
+
+    ShaderVariantCache(const ShaderVariantCache &) = delete;
+
+    ShaderVariantCache &operator=(const ShaderVariantCache &) = delete;
+
+    ~ShaderVariantCache();
+
+    /// Must be called with a current GL context, the driver strings are part of the cache key.
+    void Init(const std::filesystem::path &shaders, const std::filesystem::path &cache);
+
+    /// Program of <name>.vert/.geom/.frag with the given defines ("SKINNED", "PCF_RADIUS 2"), 0 if it does not compile.
+    unsigned int Get(const std::string &name, const std::vector<std::string> &defines);
+
+    /// Reads <name>.vert/.geom/.frag without any GL call, so it can run on another thread.
+    static Sources ReadSources(const std::filesystem::path &directory, const std::string &name);
+
+    /// Drops the loaded variants of a shader, the next Get compiles them from the given sources.
+    void Invalidate(const std::string &name, Sources shaderSources);
+
+    /// Incremented by Invalidate, the programs returned by Get before may have been deleted.
+    [[nodiscard]] std::uint32_t GetVersion() const;
+
+    /// glProgramUniform with a location looked up once, -1 is ignored like a uniform the program does not use.
+    static void SetUniform(unsigned int program, int location, int value);
+
+    static void SetUniform(unsigned int program, int location, float value);
+
+    static void SetUniform(unsigned int program, int location, const glm::vec3 &value);
+
+    static void SetUniform(unsigned int program, int location, const glm::mat4 &value);
+
+    [[nodiscard]] const ShaderVariantStats &GetStats() const;
+};
+
+#endif // PROYECTOFINAL_CGA_SHADERVARIANTCACHE_H
@@ -0,0 +1,77 @@
+#include "GlobalDefines.h"
+
+#include "ShadowCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+void ShadowCache::BeginFrame()
+{
+    skippedUpdates = 0;
+    staticUpdatedThisFrame = false;
+}
+
+bool ShadowCache::UpdateStatic(const std::size_t lightHash)
+{
+    if (staticValid && lightHash == lightSignature)
+    {
+        skippedUpdates++;
+        return false;
+    }
+
+    lightSignature = lightHash;
+    staticValid = true;
+    staticUpdatedThisFrame = true;
+    return true;
+}
+
+bool ShadowCache::UpdateDynamic(const std::size_t casterHash)
+{
+    if (dynamicValid && !staticUpdatedThisFrame && casterHash == dynamicSignature)
+    {
+        skippedUpdates++;
+        return false;
+    }
+
+    dynamicSignature = casterHash;
+    dynamicValid = true;
+    return true;
+}
+
+void ShadowCache::Invalidate()
+{
+    staticValid = false;
+    dynamicValid = false;
+}
+
+int ShadowCache::GetSkippedUpdates() const { return skippedUpdates; }
+
+std::size_t ShadowCache::Hash(const float *data, const std::size_t count, const std::size_t seed)
+{
+    // FNV-1a over the raw bytes, exact equality is what we want here
+    std::size_t hash = seed ^ 14695981039346656037ULL;
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < count * sizeof(float); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::size_t ShadowCache::Hash(const glm::mat4 &matrix, const std::size_t seed)
+{
+    return Hash(glm::value_ptr(matrix), 16, seed);
+}
+
+std::size_t ShadowCache::Hash(const std::vector<glm::mat4> &matrices, const std::size_t seed)
+{
+    if (matrices.empty()) return seed;
+    return Hash(glm::value_ptr(matrices.front()), matrices.size() * 16, seed);
+}
+
+void ShadowCache::CopyDepth(const unsigned int source, const unsigned int destination, const unsigned int target, const int width, const int height, const int layers)
+{
+    glCopyImageSubData(source, target, 0, 0, 0, 0,
+                       destination, target, 0, 0, 0, 0,
+                       width, height, layers);
+}
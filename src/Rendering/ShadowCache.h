@@ -0,0 +1,50 @@
+#ifndef PROYECTOFINAL_CGA_SHADOWCACHE_H
+#define PROYECTOFINAL_CGA_SHADOWCACHE_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Keeps track of the two layers of a cached shadow map.
+ *
+ * The static layer holds the casters that never move and is only re-rendered
+ * when the light changes. The final map is the static layer plus the dynamic
+ * casters, and is only rebuilt when the light or a dynamic caster changes.
+ */
+class ShadowCache
+{
+    std::size_t lightSignature = 0;
+    std::size_t dynamicSignature = 0;
+    bool staticValid = false;
+    bool dynamicValid = false;
+    bool staticUpdatedThisFrame = false;
+    int skippedUpdates = 0;
+
+  public:
+    /// Resets the per frame counters, must be called once before any Update* call.
+    void BeginFrame();
+
+    /// Returns true when the static layer must be rendered again for this light.
+    bool UpdateStatic(std::size_t lightHash);
+
+    /// Returns true when the final map must be recomposed for these dynamic casters.
+    bool UpdateDynamic(std::size_t casterHash);
+
+    /// Forces both layers to be rendered again on the next frame.
+    void Invalidate();
+
+    [[nodiscard]] int GetSkippedUpdates() const;
+
+    static std::size_t Hash(const float *data, std::size_t count, std::size_t seed = 0);
+
+    static std::size_t Hash(const glm::mat4 &matrix, std::size_t seed = 0);
+
+    static std::size_t Hash(const std::vector<glm::mat4> &matrices, std::size_t seed = 0);
+
+    /// Copies a depth texture (all its layers/faces) into another of the same size and format.
+    static void CopyDepth(unsigned int source, unsigned int destination, unsigned int target, int width, int height, int layers = 1);
+};
+
+#endif // PROYECTOFINAL_CGA_SHADOWCACHE_H
@@ -0,0 +1,110 @@
+#include "TransformKernel.h"
+
+#include <cmath>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+void TransformBatch::Resize(const std::size_t size)
+{
+    count = size;
+    const std::size_t padded = (size + 3) & ~static_cast<std::size_t>(3);
+    for (auto &stream : streams)
+        stream.resize(padded, 0.0f);
+}
+
+void ComputeWorldTransformsScalar(TransformBatch &batch)
+{
+    using S = TransformBatch;
+    for (std::size_t i = 0; i < batch.count; i++)
+    {
+        const float x = batch[S::RotationX][i], y = batch[S::RotationY][i], z = batch[S::RotationZ][i], w = batch[S::RotationW][i];
+        const float sx = batch[S::ScaleX][i], sy = batch[S::ScaleY][i], sz = batch[S::ScaleZ][i];
+
+        // Same as glm::mat3_cast, each column scaled
+        const float basis[3][3] = {
+            {(1.0f - 2.0f * (y * y + z * z)) * sx, 2.0f * (x * y + w * z) * sx,          2.0f * (x * z - w * y) * sx         },
+            {2.0f * (x * y - w * z) * sy,          (1.0f - 2.0f * (x * x + z * z)) * sy, 2.0f * (y * z + w * x) * sy         },
+            {2.0f * (x * z + w * y) * sz,          2.0f * (y * z - w * x) * sz,          (1.0f - 2.0f * (x * x + y * y)) * sz},
+        };
+        for (int column = 0; column < 3; column++)
+            for (int row = 0; row < 3; row++)
+                batch[static_cast<S::Stream>(S::Basis00 + column * 3 + row)][i] = basis[column][row];
+
+        const float center[3] = {(batch[S::LocalMinX][i] + batch[S::LocalMaxX][i]) * 0.5f, (batch[S::LocalMinY][i] + batch[S::LocalMaxY][i]) * 0.5f,
+                                 (batch[S::LocalMinZ][i] + batch[S::LocalMaxZ][i]) * 0.5f};
+        const float extent[3] = {(batch[S::LocalMaxX][i] - batch[S::LocalMinX][i]) * 0.5f, (batch[S::LocalMaxY][i] - batch[S::LocalMinY][i]) * 0.5f,
+                                 (batch[S::LocalMaxZ][i] - batch[S::LocalMinZ][i]) * 0.5f};
+        for (int row = 0; row < 3; row++)
+        {
+            float worldCenter = batch[static_cast<S::Stream>(S::TranslationX + row)][i];
+            float worldExtent = 0.0f;
+            for (int column = 0; column < 3; column++)
+            {
+                worldCenter += basis[column][row] * center[column];
+                worldExtent += std::abs(basis[column][row]) * extent[column];
+            }
+            batch[static_cast<S::Stream>(S::WorldMinX + row)][i] = worldCenter - worldExtent;
+            batch[static_cast<S::Stream>(S::WorldMaxX + row)][i] = worldCenter + worldExtent;
+        }
+    }
+}
+
+void ComputeWorldTransforms(TransformBatch &batch)
+{
+#if defined(__SSE__)
+    using S = TransformBatch;
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const auto load = [&batch](const S::Stream stream, const std::size_t i) -> __m128 { return _mm_loadu_ps(batch[stream] + i); };
+    const auto store = [&batch](const S::Stream stream, const std::size_t i, const __m128 value) { _mm_storeu_ps(batch[stream] + i, value); };
+
+    for (std::size_t i = 0; i < batch.count; i += 4)
+    {
+        const __m128 x = load(S::RotationX, i), y = load(S::RotationY, i), z = load(S::RotationZ, i), w = load(S::RotationW, i);
+        const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+        const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+        const __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+        const __m128 sx = load(S::ScaleX, i), sy = load(S::ScaleY, i), sz = load(S::ScaleZ, i);
+
+        // basis[column][row], same as the scalar version
+        const __m128 basis[3][3] = {
+            {_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx), _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx),
+             _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx)},
+            {_mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy), _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy),
+             _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy)},
+            {_mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz), _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz),
+             _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz)},
+        };
+        for (int column = 0; column < 3; column++)
+            for (int row = 0; row < 3; row++)
+                store(static_cast<S::Stream>(S::Basis00 + column * 3 + row), i, basis[column][row]);
+
+        __m128 center[3], extent[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const __m128 min = load(static_cast<S::Stream>(S::LocalMinX + axis), i);
+            const __m128 max = load(static_cast<S::Stream>(S::LocalMaxX + axis), i);
+            center[axis] = _mm_mul_ps(_mm_add_ps(min, max), half);
+            extent[axis] = _mm_mul_ps(_mm_sub_ps(max, min), half);
+        }
+        for (int row = 0; row < 3; row++)
+        {
+            __m128 worldCenter = load(static_cast<S::Stream>(S::TranslationX + row), i);
+            __m128 worldExtent = _mm_setzero_ps();
+            for (int column = 0; column < 3; column++)
+            {
+                worldCenter = _mm_add_ps(worldCenter, _mm_mul_ps(basis[column][row], center[column]));
+                worldExtent = _mm_add_ps(worldExtent, _mm_mul_ps(_mm_andnot_ps(signMask, basis[column][row]), extent[column]));
+            }
+            store(static_cast<S::Stream>(S::WorldMinX + row), i, _mm_sub_ps(worldCenter, worldExtent));
+            store(static_cast<S::Stream>(S::WorldMaxX + row), i, _mm_add_ps(worldCenter, worldExtent));
+        }
+    }
+#else
+    ComputeWorldTransformsScalar(batch);
+#endif
+}
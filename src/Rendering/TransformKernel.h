@@ -0,0 +1,76 @@
+#ifndef PROYECTOFINAL_CGA_TRANSFORMKERNEL_H
+#define PROYECTOFINAL_CGA_TRANSFORMKERNEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Transforms laid out as one float array per component, the input and output
+ * of ComputeWorldTransforms.
+ *
+ * The arrays are padded to a multiple of four so the SIMD kernel never needs
+ * a scalar tail. The basis is rotation * scale in column major order, the
+ * world matrix is that basis with the translation as the last column.
+ */
+struct TransformBatch
+{
+    enum Stream : std::uint8_t
+    {
+        // Inputs
+        TranslationX,
+        TranslationY,
+        TranslationZ,
+        RotationX,
+        RotationY,
+        RotationZ,
+        RotationW,
+        ScaleX,
+        ScaleY,
+        ScaleZ,
+        LocalMinX,
+        LocalMinY,
+        LocalMinZ,
+        LocalMaxX,
+        LocalMaxY,
+        LocalMaxZ,
+        // Outputs
+        Basis00,
+        Basis01,
+        Basis02,
+        Basis10,
+        Basis11,
+        Basis12,
+        Basis20,
+        Basis21,
+        Basis22,
+        WorldMinX,
+        WorldMinY,
+        WorldMinZ,
+        WorldMaxX,
+        WorldMaxY,
+        WorldMaxZ,
+        StreamCount
+    };
+
+    std::array<std::vector<float>, StreamCount> streams;
+    std::size_t count = 0;
+
+    void Resize(std::size_t size);
+
+    float *operator[](const Stream stream) { return streams[stream].data(); }
+
+    const float *operator[](const Stream stream) const { return streams[stream].data(); }
+};
+
+/**
+ * Computes the basis and the world AABB (the box enclosing the transformed
+ * local box) of every transform in the batch, four at a time with SSE.
+ */
+void ComputeWorldTransforms(TransformBatch &batch);
+
+/// Same results one transform at a time, used when SSE is not available and as the benchmark baseline.
+void ComputeWorldTransformsScalar(TransformBatch &batch);
+
+#endif // PROYECTOFINAL_CGA_TRANSFORMKERNEL_H
@@ -0,0 +1,117 @@
+#include "ActionQueue.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+
+namespace
+{
+GLFWkeyfun previousKeyCallback = nullptr;
+}
+
+ActionQueue *ActionQueue::GetInstance()
+{
+    static ActionQueue instance;
+    return &instance;
+}
+
+void ActionQueue::KeyCallback(GLFWwindow *window, const int key, const int scancode, const int action, const int mods)
+{
+    if (previousKeyCallback) previousKeyCallback(window, key, scancode, action, mods);
+    if (action == GLFW_REPEAT) return;
+    GetInstance()->Push({.code = key, .gamepad = false, .pressed = action == GLFW_PRESS, .time = glfwGetTime()});
+}
+
+void ActionQueue::Install(GLFWwindow *window)
+{
+    const GLFWkeyfun previous = glfwSetKeyCallback(window, KeyCallback);
+    // Installing twice would make the callback call itself
+    if (previous != KeyCallback) previousKeyCallback = previous;
+}
+
+void ActionQueue::Push(const InputEvent &event)
+{
+    // Full ring, the oldest event is lost
+    if (ringSize == Capacity)
+    {
+        ringHead = (ringHead + 1) % Capacity;
+        ringSize--;
+        latency.droppedEvents++;
+    }
+    ring[(ringHead + ringSize) % Capacity] = event;
+    ringSize++;
+}
+
+ActionQueue &ActionQueue::BindKey(const Action action, const int key)
+{
+    bindings.push_back({action, key, false});
+    return *this;
+}
+
+ActionQueue &ActionQueue::BindGamepadButton(const Action action, const int button)
+{
+    bindings.push_back({action, button, true});
+    return *this;
+}
+
+void ActionQueue::BeginFrame()
+{
+    const double now = glfwGetTime();
+
+    // GLFW has no gamepad callbacks, the buttons are compared with the last poll
+    if (GLFWgamepadstate state; glfwJoystickIsGamepad(GLFW_JOYSTICK_1) && glfwGetGamepadState(GLFW_JOYSTICK_1, &state))
+    {
+        for (std::size_t button = 0; button < gamepadButtons.size(); button++)
+        {
+            if (state.buttons[button] == gamepadButtons[button]) continue;
+            gamepadButtons[button] = state.buttons[button];
+            Push({.code = static_cast<int>(button), .gamepad = true, .pressed = state.buttons[button] == GLFW_PRESS, .time = now});
+        }
+    }
+
+    pressCounts.fill(0);
+    for (; ringSize > 0; ringSize--, ringHead = (ringHead + 1) % Capacity)
+    {
+        const InputEvent &event = ring[ringHead];
+        bool mapped = false;
+        for (const auto &[action, code, gamepad] : bindings)
+        {
+            if (code != event.code || gamepad != event.gamepad) continue;
+            const auto index = static_cast<std::size_t>(action);
+            if (event.pressed)
+                pressCounts[index]++;
+            heldInputs[index] = std::max(heldInputs[index] + (event.pressed ? 1 : -1), 0);
+            mapped = true;
+        }
+
+        if (!mapped || !event.pressed) continue;
+        latency.lastMilliseconds = static_cast<float>((now - event.time) * 1000.0);
+        latency.averageMilliseconds += (latency.lastMilliseconds - latency.averageMilliseconds) * 0.1f;
+        latency.maxMilliseconds = std::max(latency.maxMilliseconds, latency.lastMilliseconds);
+    }
+}
+
+int ActionQueue::GetPressCount(const Action action) const { return pressCounts[static_cast<std::size_t>(action)]; }
+
+bool ActionQueue::WasPressed(const Action action) const { return GetPressCount(action) > 0; }
+
+bool ActionQueue::IsHeld(const Action action) const { return heldInputs[static_cast<std::size_t>(action)] > 0; }
+
+const ActionQueue::PressCounts &ActionQueue::GetPressCounts() const { return pressCounts; }
+
+std::uint32_t ActionQueue::GetHeldMask() const
+{
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < ActionCount; i++)
+        if (heldInputs[i] > 0) mask |= 1u << i;
+    return mask;
+}
+
+void ActionQueue::Override(const PressCounts &presses, const std::uint32_t heldMask)
+{
+    pressCounts = presses;
+    for (std::size_t i = 0; i < ActionCount; i++)
+        heldInputs[i] = (heldMask >> i) & 1u ? 1 : 0;
+}
+
+const InputLatencyStats &ActionQueue::GetLatencyStats() const { return latency; }
@@ -0,0 +1,120 @@
+#ifndef PROYECTOFINAL_CGA_ACTIONQUEUE_H
+#define PROYECTOFINAL_CGA_ACTIONQUEUE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct GLFWwindow;
+
+enum class Action : std::uint8_t
+{
+    MenuUp,
+    MenuDown,
+    Confirm,
+    Restart,
+    MoveLeft,
+    MoveRight,
+    Jump,
+    Dive,
+    Quit,
+    ToggleCursor,
+    ToggleFullscreen,
+    ToggleDebugGui,
+    ToggleFreeCamera,
+    Continue,
+    Screenshot,
+    Count
+};
+
+struct InputEvent
+{
+    int code = 0;
+    bool gamepad = false;
+    bool pressed = false;
+    double time = 0.0;
+};
+
+struct InputLatencyStats
+{
+    float lastMilliseconds = 0.0f;
+    float averageMilliseconds = 0.0f;
+    float maxMilliseconds = 0.0f;
+    std::uint32_t droppedEvents = 0;
+};
+
+/**
+ * Timestamped key and gamepad button events mapped to gameplay actions.
+ *
+ * The GLFW key callback (chained after the engine Keyboard's) pushes every
+ * press and release into a ring buffer, gamepad buttons are compared with the
+ * previous poll. BeginFrame drains the ring once per frame, so a key pressed
+ * and released between two frames still counts, and measures how long each
+ * press waited before the game could see it.
+ */
+class ActionQueue
+{
+  public:
+    static constexpr auto ActionCount = static_cast<std::size_t>(Action::Count);
+    using PressCounts = std::array<int, ActionCount>;
+
+  private:
+    static constexpr std::size_t Capacity = 128;
+
+    struct Binding
+    {
+        Action action;
+        int code;
+        bool gamepad;
+    };
+
+    std::array<InputEvent, Capacity> ring{};
+    std::size_t ringHead = 0;
+    std::size_t ringSize = 0;
+
+    std::vector<Binding> bindings;
+    PressCounts pressCounts{};
+    std::array<int, ActionCount> heldInputs{};
+    std::array<unsigned char, 15> gamepadButtons{}; // GLFW_GAMEPAD_BUTTON_LAST + 1
+    InputLatencyStats latency{};
+
+    static void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
+
+    void Push(const InputEvent &event);
+
+    ActionQueue() = default;
+
+  public:
+    static ActionQueue *GetInstance();
+
+    /// Installs the key callback, after the engine set its own so both keep receiving the keys.
+    void Install(GLFWwindow *window);
+
+    ActionQueue &BindKey(Action action, int key);
+
+    ActionQueue &BindGamepadButton(Action action, int button);
+
+    /// Turns the events since the last frame into this frame's actions.
+    void BeginFrame();
+
+    /// Number of times the action was pressed since the last frame.
+    [[nodiscard]] int GetPressCount(Action action) const;
+
+    [[nodiscard]] bool WasPressed(Action action) const;
+
+    /// True while one of the inputs bound to the action is down.
+    [[nodiscard]] bool IsHeld(Action action) const;
+
+    [[nodiscard]] const PressCounts &GetPressCounts() const;
+
+    /// Bit i set while action i is held.
+    [[nodiscard]] std::uint32_t GetHeldMask() const;
+
+    /// Replaces this frame's actions, used to replay a recorded session.
+    void Override(const PressCounts &presses, std::uint32_t heldMask);
+
+    [[nodiscard]] const InputLatencyStats &GetLatencyStats() const;
+};
+
+#endif // PROYECTOFINAL_CGA_ACTIONQUEUE_H
@@ -0,0 +1,67 @@
+#include "AllocationCounter.h"
+
+#include "MemoryTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<std::uint64_t> allocations = 0;
+std::atomic<std::uint64_t> allocatedBytes = 0;
+
+void *AllocateOrThrow(const std::size_t size)
+{
+    while (true)
+    {
+        if (void *pointer = std::malloc(size == 0 ? 1 : size)) return pointer;
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+#ifdef ENABLE_MEMORY_TRACKING
+// In front of every block, the delete needs the size and tag to give the bytes back
+struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) BlockHeader
+{
+    std::size_t size;
+    MemoryTag tag;
+};
+#endif
+} // namespace
+
+std::uint64_t AllocationCounter::GetCount() { return allocations.load(std::memory_order_relaxed); }
+
+std::uint64_t AllocationCounter::GetBytes() { return allocatedBytes.load(std::memory_order_relaxed); }
+
+// The standard library builds new[], nothrow new and the other deletes on top of these
+void *operator new(const std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+#ifdef ENABLE_MEMORY_TRACKING
+    auto *header = static_cast<BlockHeader *>(AllocateOrThrow(sizeof(BlockHeader) + size));
+    header->size = size;
+    header->tag = MemoryTracker::GetCurrentTag();
+    MemoryTracker::RecordAllocation(header->tag, size);
+    return header + 1;
+#else
+    return AllocateOrThrow(size);
+#endif
+}
+
+void operator delete(void *pointer) noexcept
+{
+#ifdef ENABLE_MEMORY_TRACKING
+    if (!pointer) return;
+    BlockHeader *header = static_cast<BlockHeader *>(pointer) - 1;
+    MemoryTracker::RecordFree(header->tag, header->size);
+    std::free(header);
+#else
+    std::free(pointer);
+#endif
+}
+
+void operator delete(void *pointer, [[maybe_unused]] std::size_t size) noexcept { operator delete(pointer); }
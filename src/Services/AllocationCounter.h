@@ -0,0 +1,21 @@
+#ifndef PROYECTOFINAL_CGA_ALLOCATIONCOUNTER_H
+#define PROYECTOFINAL_CGA_ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+/**
+ * Counts the calls to the global operator new, which is replaced in the .cpp.
+ * Arrays and nothrow allocations go through it as well, the over-aligned ones
+ * are not counted. With ENABLE_MEMORY_TRACKING it also charges every
+ * allocation to a MemoryTag, see MemoryTracker.h.
+ */
+namespace AllocationCounter
+{
+/// Allocations since the program started.
+std::uint64_t GetCount();
+
+/// Bytes requested since the program started, frees are not subtracted.
+std::uint64_t GetBytes();
+} // namespace AllocationCounter
+
+#endif // PROYECTOFINAL_CGA_ALLOCATIONCOUNTER_H
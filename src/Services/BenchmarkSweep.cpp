@@ -0,0 +1,147 @@
+#include "BenchmarkSweep.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iostream>
+
+void BenchmarkSweep::Start(const std::filesystem::path &output)
+{
+    outputPath = output;
+    running = true;
+    stepIndex = -1;
+    frame = 0;
+    steps.clear();
+    sectionNames.clear();
+}
+
+bool BenchmarkSweep::BeginFrame()
+{
+    if (!running) return false;
+    if (stepIndex >= 0 && frame < warmupFrames + measuredFrames)
+    {
+        frame++;
+        return false;
+    }
+
+    if (stepIndex >= 0)
+    {
+        BenchmarkStep &step = steps.back();
+        step.frameMilliseconds /= static_cast<float>(measuredFrames);
+        for (auto &milliseconds : step.sectionMilliseconds)
+            milliseconds /= static_cast<float>(measuredFrames);
+        std::cout << std::format("Benchmark x{}: {:.2f} ms average, {:.2f} ms worst\n", step.multiplier, step.frameMilliseconds, step.worstFrameMilliseconds);
+    }
+
+    if (++stepIndex >= static_cast<int>(multipliers.size()))
+    {
+        running = false;
+        return false;
+    }
+
+    steps.push_back({.multiplier = GetMultiplier(), .load = GetLoad()});
+    frame = 1;
+    return true;
+}
+
+void BenchmarkSweep::EndFrame(const FrameProfiler &profiler)
+{
+    if (!running || stepIndex < 0 || frame <= warmupFrames) return;
+
+    BenchmarkStep &step = steps.back();
+    const auto &names = profiler.GetNames();
+    const auto &times = profiler.GetLastFrame();
+    for (std::size_t i = 0; i < names.size(); i++)
+    {
+        // Sections may first appear in a later step, the columns are the union of all of them
+        auto it = std::ranges::find(sectionNames, names[i]);
+        if (it == sectionNames.end())
+            it = sectionNames.insert(sectionNames.end(), names[i]);
+        const auto column = static_cast<std::size_t>(it - sectionNames.begin());
+        if (step.sectionMilliseconds.size() <= column) step.sectionMilliseconds.resize(column + 1, 0.0f);
+        step.sectionMilliseconds[column] += times[i];
+    }
+
+    step.frameMilliseconds += profiler.GetLastFrameMilliseconds();
+    step.worstFrameMilliseconds = std::max(step.worstFrameMilliseconds, profiler.GetLastFrameMilliseconds());
+}
+
+bool BenchmarkSweep::IsRunning() const { return running; }
+
+bool BenchmarkSweep::IsFinished() const { return !running && stepIndex >= static_cast<int>(multipliers.size()); }
+
+BenchmarkLoad BenchmarkSweep::GetLoad() const
+{
+    const int multiplier = GetMultiplier();
+    return {
+        .coins = baseLoad.coins * multiplier,
+        .obstacles = baseLoad.obstacles * multiplier,
+        .buildings = baseLoad.buildings * multiplier,
+        .pointLights = baseLoad.pointLights * multiplier,
+        .runners = baseLoad.runners * multiplier,
+    };
+}
+
+int BenchmarkSweep::GetMultiplier() const
+{
+    if (stepIndex < 0 || stepIndex >= static_cast<int>(multipliers.size())) return 0;
+    return multipliers[static_cast<std::size_t>(stepIndex)];
+}
+
+const std::vector<BenchmarkStep> &BenchmarkSweep::GetSteps() const { return steps; }
+
+bool BenchmarkSweep::Write() const
+{
+    nlohmann::json stepsData = nlohmann::json::array();
+    std::string csv = "multiplier,coins,obstacles,buildings,point_lights,runners,frame_ms,worst_frame_ms";
+    for (const auto &name : sectionNames)
+        csv += ',' + name + "_ms";
+    csv += '\n';
+
+    for (const auto &[multiplier, load, frameMilliseconds, worstFrameMilliseconds, sectionMilliseconds] : steps)
+    {
+        nlohmann::json sections = nlohmann::json::object();
+        csv += std::format("{},{},{},{},{},{},{:.4f},{:.4f}", multiplier, load.coins, load.obstacles, load.buildings, load.pointLights, load.runners,
+                           frameMilliseconds, worstFrameMilliseconds);
+        for (std::size_t i = 0; i < sectionNames.size(); i++)
+        {
+            const float milliseconds = i < sectionMilliseconds.size() ? sectionMilliseconds[i] : 0.0f;
+            sections[sectionNames[i].c_str()] = milliseconds;
+            csv += std::format(",{:.4f}", milliseconds);
+        }
+        csv += '\n';
+
+        stepsData.push_back(nlohmann::json{
+            {"multiplier", multiplier},
+            {"coins", load.coins},
+            {"obstacles", load.obstacles},
+            {"buildings", load.buildings},
+            {"point_lights", load.pointLights},
+            {"runners", load.runners},
+            {"frame_ms", frameMilliseconds},
+            {"worst_frame_ms", worstFrameMilliseconds},
+            {"sections", sections},
+        });
+    }
+
+    std::filesystem::path jsonPath = outputPath;
+    std::filesystem::path csvPath = outputPath;
+    std::ofstream jsonStream(jsonPath.replace_extension(".json"));
+    std::ofstream csvStream(csvPath.replace_extension(".csv"));
+    if (!jsonStream.is_open() || !csvStream.is_open())
+    {
+        std::cerr << "\033[31mCannot write the benchmark results to " << outputPath << "\033[0m\n";
+        return false;
+    }
+
+    jsonStream << nlohmann::json{
+        {"warmup_frames", warmupFrames},
+        {"measured_frames", measuredFrames},
+        {"steps", stepsData},
+    }.dump(2);
+    csvStream << csv;
+    std::cout << "Benchmark results written to " << jsonPath << " and " << csvPath << '\n';
+    return true;
+}
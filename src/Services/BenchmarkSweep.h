@@ -0,0 +1,77 @@
+#ifndef PROYECTOFINAL_CGA_BENCHMARKSWEEP_H
+#define PROYECTOFINAL_CGA_BENCHMARKSWEEP_H
+
+#include "FrameProfiler.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/// Amount of each prefab spawned by one step of the sweep.
+struct BenchmarkLoad
+{
+    int coins = 0;
+    int obstacles = 0;
+    int buildings = 0;
+    int pointLights = 0;
+    int runners = 0;
+};
+
+struct BenchmarkStep
+{
+    int multiplier = 1;
+    BenchmarkLoad load;
+    float frameMilliseconds = 0.0f;
+    float worstFrameMilliseconds = 0.0f;
+    std::vector<float> sectionMilliseconds;
+};
+
+/**
+ * Stress test that multiplies a base load step by step.
+ *
+ * Each step spawns its load, lets a few frames warm up (shadow caches, LOD
+ * selection, buffer growth) and then averages the frame profiler sections
+ * over the measured frames. The scaling curve is written as JSON and CSV,
+ * one row per step and one column per profiler section.
+ */
+class BenchmarkSweep
+{
+    BenchmarkLoad baseLoad{.coins = 24, .obstacles = 8, .buildings = 4, .pointLights = 4, .runners = 1};
+    std::vector<int> multipliers = {1, 2, 4, 8, 16, 32};
+    int warmupFrames = 30;
+    int measuredFrames = 120;
+
+    std::filesystem::path outputPath;
+    bool running = false;
+    int stepIndex = -1;
+    int frame = 0;
+    std::vector<std::string> sectionNames;
+    std::vector<BenchmarkStep> steps;
+
+  public:
+    /// Results go to <output>.json and <output>.csv.
+    void Start(const std::filesystem::path &output);
+
+    /**
+     * Called at the start of every frame, returns true when the next step begins and
+     * its load (GetLoad) must replace the current one.
+     */
+    bool BeginFrame();
+
+    /// Adds the frame that just ended to the current step once it is warmed up.
+    void EndFrame(const FrameProfiler &profiler);
+
+    [[nodiscard]] bool IsRunning() const;
+
+    [[nodiscard]] bool IsFinished() const;
+
+    [[nodiscard]] BenchmarkLoad GetLoad() const;
+
+    [[nodiscard]] int GetMultiplier() const;
+
+    [[nodiscard]] const std::vector<BenchmarkStep> &GetSteps() const;
+
+    bool Write() const;
+};
+
+#endif // PROYECTOFINAL_CGA_BENCHMARKSWEEP_H
@@ -0,0 +1,193 @@
+#ifndef PROYECTOFINAL_CGA_COMPONENTLIST_H
+#define PROYECTOFINAL_CGA_COMPONENTLIST_H
+
+#include "EntityCommandBuffer.h"
+#include "ECS/Registry.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Component types known at compile time, in a fixed order.
+ *
+ * The index of a type is its position in the list and a set of types is a
+ * bit mask of those indices, both computed by the compiler. Registering the
+ * list registers every type in the registry, so a query over the list can
+ * reject a component that was never registered before the game runs.
+ * EntitySignatures keeps the mask of every entity, queries test it instead of
+ * asking the registry for each component.
+ */
+template <typename... Components>
+struct ComponentList
+{
+    using Mask = std::uint64_t;
+
+    static constexpr std::size_t Size = sizeof...(Components);
+    static_assert(Size <= 64, "The mask has one bit per component");
+
+    template <typename T>
+    static constexpr bool Contains = (std::is_same_v<T, Components> || ...);
+
+    template <typename T>
+    static consteval std::size_t IndexOf()
+    {
+        static_assert(Contains<T>, "Component not in the list");
+        constexpr std::array<bool, Size> matches = {std::is_same_v<T, Components>...};
+        std::size_t index = 0;
+        while (index < Size && !matches[index])
+            index++;
+        return index;
+    }
+
+    template <typename... Ts>
+    static constexpr Mask MaskOf = (Mask{0} | ... | (Mask{1} << IndexOf<Ts>()));
+
+    /// The same types as arguments of another template, like RegistrySnapshot.
+    template <template <typename...> class Target>
+    using Apply = Target<Components...>;
+
+    static void Register(ECS::Registry &registry) { (registry.RegisterComponent<Components>(), ...); }
+
+    /// Mask of the components the entity has in the registry.
+    static Mask SignatureOf(ECS::Registry &registry, const ECS::Entity entity)
+    {
+        return (Mask{0} | ... | (registry.HasComponent<Components>(entity) ? MaskOf<Components> : Mask{0}));
+    }
+
+    /// Calls function(entity, bit) for every owner of each component, one component at a time.
+    template <typename Function>
+    static void ForEachOwner(ECS::Registry &registry, Function &&function)
+    {
+        (
+            [&registry, &function]
+            {
+                for (const ECS::Entity entity : registry.View<Components>())
+                    function(entity, MaskOf<Components>);
+            }(),
+            ...);
+    }
+};
+
+/**
+ * Component mask of every entity, indexed by its id.
+ *
+ * Playbacks of the command buffer update it as its observer. Code that adds
+ * components straight to the registry calls Refresh for that entity, and a
+ * registry that was reset or restored from a snapshot needs a Rebuild.
+ */
+template <typename List>
+class EntitySignatures final : public PlaybackObserver
+{
+    using Mask = typename List::Mask;
+
+    std::vector<Mask> masks;
+
+  public:
+    /// 0 for an entity that was never seen.
+    [[nodiscard]] Mask Get(const ECS::Entity entity) const { return entity < masks.size() ? masks[entity] : Mask{0}; }
+
+    /// Reads the entity's components again from the registry.
+    void Refresh(ECS::Registry &registry, const ECS::Entity entity)
+    {
+        if (entity >= masks.size()) masks.resize(entity + 1, Mask{0});
+        masks[entity] = List::SignatureOf(registry, entity);
+    }
+
+    /// Every entity of the registry, one pass over each component pool.
+    void Rebuild(ECS::Registry &registry)
+    {
+        masks.clear();
+        List::ForEachOwner(registry,
+                           [this](const ECS::Entity entity, const Mask bit)
+                           {
+                               if (entity >= masks.size()) masks.resize(entity + 1, Mask{0});
+                               masks[entity] |= bit;
+                           });
+    }
+
+    void OnComponentsChanged(ECS::Registry &registry, const ECS::Entity entity) override { Refresh(registry, entity); }
+
+    void OnDestroyed(const ECS::Entity entity) override
+    {
+        if (entity < masks.size()) masks[entity] = Mask{0};
+    }
+};
+
+/// Components an entity must not have, as the last argument of a Query.
+template <typename... Components>
+struct Exclude
+{
+};
+
+namespace Detail
+{
+/// Splits the query arguments into the included components and the trailing Exclude.
+template <typename IncludeList, typename... Args>
+struct SplitQuery;
+
+template <typename... Included>
+struct SplitQuery<ComponentList<Included...>>
+{
+    using IncludeList = ComponentList<Included...>;
+    using ExcludeList = ComponentList<>;
+};
+
+template <typename... Included, typename... Excluded>
+struct SplitQuery<ComponentList<Included...>, Exclude<Excluded...>>
+{
+    using IncludeList = ComponentList<Included...>;
+    using ExcludeList = ComponentList<Excluded...>;
+};
+
+template <typename... Included, typename T, typename... Rest>
+struct SplitQuery<ComponentList<Included...>, T, Rest...> : SplitQuery<ComponentList<Included..., T>, Rest...>
+{
+};
+} // namespace Detail
+
+template <typename List, typename IncludeList, typename ExcludeList>
+struct BasicQuery;
+
+template <typename List, typename... Included, typename... Excluded>
+struct BasicQuery<List, ComponentList<Included...>, ComponentList<Excluded...>>
+{
+    static_assert(sizeof...(Included) > 0, "A query needs at least one component");
+    static_assert((List::template Contains<Included> && ...) && (List::template Contains<Excluded> && ...),
+                  "Query on a component that is not registered");
+
+    static constexpr typename List::Mask IncludeMask = List::template MaskOf<Included...>;
+    static constexpr typename List::Mask ExcludeMask = List::template MaskOf<Excluded...>;
+    static_assert((IncludeMask & ExcludeMask) == 0, "A component cannot be both included and excluded");
+
+    /// Entities with every included component.
+    static std::vector<ECS::Entity> View(ECS::Registry &registry)
+        requires(sizeof...(Excluded) == 0)
+    {
+        return registry.View<Included...>();
+    }
+
+    /// Entities with every included component and none of the excluded ones.
+    static std::vector<ECS::Entity> View(ECS::Registry &registry, const EntitySignatures<List> &signatures)
+    {
+        std::vector<ECS::Entity> entities = registry.View<Included...>();
+        if constexpr (ExcludeMask != 0)
+            std::erase_if(entities, [&signatures](const ECS::Entity entity) { return (signatures.Get(entity) & ExcludeMask) != 0; });
+        return entities;
+    }
+
+    /// The same test for a single entity, like the ones in a collider's contacts.
+    static bool Matches(const EntitySignatures<List> &signatures, const ECS::Entity entity)
+    {
+        const typename List::Mask signature = signatures.Get(entity);
+        return (signature & IncludeMask) == IncludeMask && (signature & ExcludeMask) == 0;
+    }
+};
+
+/// Query<List, A, B, Exclude<C>>: entities with A and B but without C, checked against the list at compile time.
+template <typename List, typename... Args>
+using Query = BasicQuery<List, typename Detail::SplitQuery<ComponentList<>, Args...>::IncludeList, typename Detail::SplitQuery<ComponentList<>, Args...>::ExcludeList>;
+
+#endif // PROYECTOFINAL_CGA_COMPONENTLIST_H
@@ -0,0 +1,165 @@
+#include "EntityCommandBuffer.h"
+
+#include <algorithm>
+
+std::uint32_t EntityCommandBuffer::NextComponentType()
+{
+    static std::atomic<std::uint32_t> types = 0;
+    return types.fetch_add(1, std::memory_order_relaxed);
+}
+
+EntityCommandBuffer::EntityCommandBuffer() : head(new Chunk), tail(head) {}
+
+EntityCommandBuffer::~EntityCommandBuffer()
+{
+    Clear();
+    for (Chunk *chunk = head; chunk;)
+    {
+        Chunk *next = chunk->next.load(std::memory_order_relaxed);
+        delete chunk;
+        chunk = next;
+    }
+}
+
+EntityCommandBuffer::Command &EntityCommandBuffer::Reserve()
+{
+    Chunk *chunk = tail.load(std::memory_order_acquire);
+    while (true)
+    {
+        const std::uint32_t index = chunk->used.fetch_add(1, std::memory_order_relaxed);
+        if (index < Chunk::Capacity) return chunk->commands[index];
+
+        // Full, the first thread to get here links the next chunk, recycled from an earlier frame or new
+        Chunk *next = chunk->next.load(std::memory_order_acquire);
+        if (!next)
+        {
+            auto *created = new Chunk;
+            if (chunk->next.compare_exchange_strong(next, created, std::memory_order_acq_rel))
+                next = created;
+            else
+                delete created;
+        }
+        // On failure another thread moved the tail already, chunk is now the current one
+        if (tail.compare_exchange_strong(chunk, next, std::memory_order_acq_rel)) chunk = next;
+    }
+}
+
+ECS::Entity EntityCommandBuffer::Create()
+{
+    const ECS::Entity placeholder = DeferredBit | placeholders.fetch_add(1, std::memory_order_relaxed);
+    Command &command = Reserve();
+    command.kind = Command::Kind::Create;
+    command.entity = placeholder;
+    command.apply = nullptr;
+    command.destroy = nullptr;
+    return placeholder;
+}
+
+EntityCommandBuffer &EntityCommandBuffer::Destroy(const ECS::Entity entity)
+{
+    Command &command = Reserve();
+    command.kind = Command::Kind::Destroy;
+    command.entity = entity;
+    command.apply = nullptr;
+    command.destroy = nullptr;
+    return *this;
+}
+
+ECS::Entity EntityCommandBuffer::Resolve(const ECS::Entity entity) const
+{
+    return (entity & DeferredBit) ? createdEntities[entity & ~DeferredBit] : entity;
+}
+
+bool EntityCommandBuffer::IsDestroyed(const ECS::Entity entity) const { return std::ranges::binary_search(destroyedEntities, entity); }
+
+void EntityCommandBuffer::ForEachCommand(auto &&function)
+{
+    for (Chunk *chunk = head; chunk; chunk = chunk->next.load(std::memory_order_relaxed))
+    {
+        const std::uint32_t used = std::min(chunk->used.load(std::memory_order_relaxed), Chunk::Capacity);
+        for (std::uint32_t i = 0; i < used; i++)
+            function(chunk->commands[i]);
+        if (used < Chunk::Capacity) break;
+    }
+}
+
+void EntityCommandBuffer::Playback(ECS::Registry &registry)
+{
+    if (IsEmpty()) return;
+
+    createdEntities.assign(placeholders.load(std::memory_order_relaxed), 0);
+    destroyedEntities.clear();
+    componentCommands.clear();
+
+    ForEachCommand(
+        [&](Command &command)
+        {
+            stats.commands++;
+            switch (command.kind)
+            {
+            case Command::Kind::Create:
+                createdEntities[command.entity & ~DeferredBit] = registry.CreateEntity();
+                stats.created++;
+                break;
+            case Command::Kind::Add:
+            case Command::Kind::Remove:
+                componentCommands.push_back(&command);
+                break;
+            case Command::Kind::Destroy:
+                destroyedEntities.push_back(command.entity);
+                break;
+            }
+        });
+
+    for (ECS::Entity &entity : destroyedEntities)
+        entity = Resolve(entity);
+    std::ranges::sort(destroyedEntities);
+    const auto repeated = std::ranges::unique(destroyedEntities);
+    stats.skipped += repeated.size();
+    destroyedEntities.erase(repeated.begin(), repeated.end());
+
+    // Grouped by component type, in recording order within a type
+    std::ranges::stable_sort(componentCommands, {}, &Command::componentType);
+    for (Command *command : componentCommands)
+    {
+        const ECS::Entity entity = Resolve(command->entity);
+        if (IsDestroyed(entity))
+            stats.skipped++;
+        else
+        {
+            command->apply(registry, entity, command->payload.data());
+            if (observer) observer->OnComponentsChanged(registry, entity);
+        }
+    }
+
+    for (const ECS::Entity entity : destroyedEntities)
+    {
+        registry.DestroyEntity(entity);
+        if (observer) observer->OnDestroyed(entity);
+    }
+    stats.destroyed += destroyedEntities.size();
+
+    Clear();
+}
+
+void EntityCommandBuffer::SetObserver(PlaybackObserver *playbackObserver) { observer = playbackObserver; }
+
+void EntityCommandBuffer::Clear()
+{
+    ForEachCommand(
+        [](Command &command)
+        {
+            if (command.destroy) command.destroy(command.payload.data());
+            command.destroy = nullptr;
+        });
+    for (Chunk *chunk = head; chunk; chunk = chunk->next.load(std::memory_order_relaxed))
+        chunk->used.store(0, std::memory_order_relaxed);
+    tail.store(head, std::memory_order_release);
+    placeholders.store(0, std::memory_order_relaxed);
+}
+
+bool EntityCommandBuffer::IsEmpty() const { return head->used.load(std::memory_order_relaxed) == 0; }
+
+const EntityCommandStats &EntityCommandBuffer::GetStats() const { return stats; }
+
+void EntityCommandBuffer::ResetStats() { stats = {}; }
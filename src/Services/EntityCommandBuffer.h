@@ -0,0 +1,169 @@
+#ifndef PROYECTOFINAL_CGA_ENTITYCOMMANDBUFFER_H
+#define PROYECTOFINAL_CGA_ENTITYCOMMANDBUFFER_H
+
+#include "ECS/Registry.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+struct EntityCommandStats
+{
+    std::size_t commands = 0;
+    std::size_t created = 0;
+    std::size_t destroyed = 0;
+    /// Commands on entities destroyed in the same playback, and repeated destroys.
+    std::size_t skipped = 0;
+};
+
+/// Told about the entities a playback changed, once the registry has the changes.
+class PlaybackObserver
+{
+  public:
+    virtual ~PlaybackObserver() = default;
+
+    virtual void OnComponentsChanged(ECS::Registry &registry, ECS::Entity entity) = 0;
+
+    virtual void OnDestroyed(ECS::Entity entity) = 0;
+};
+
+/**
+ * Structural changes of the registry recorded now and applied at a sync point.
+ *
+ * Any number of threads can record at the same time without locks: commands
+ * go to fixed-size chunks and each one takes its slot with an atomic
+ * increment, a full chunk is followed by a recycled one or a new one linked
+ * with a compare-and-swap. Playback runs on one thread while nobody records:
+ * the entities are created first, the components are added grouped by type so
+ * each pool grows in one run, and the destroys come last, once per entity.
+ * Commands on an entity destroyed in the same playback are skipped, so a
+ * system can destroy what another one is still iterating.
+ *
+ * Create returns a placeholder id that the other commands of the buffer
+ * accept, it becomes a real entity at playback.
+ */
+class EntityCommandBuffer
+{
+    static constexpr ECS::Entity DeferredBit = 0x80000000u;
+    static constexpr std::size_t PayloadSize = 112;
+
+    struct Command
+    {
+        enum class Kind : std::uint8_t
+        {
+            Create,
+            Add,
+            Remove,
+            Destroy
+        };
+
+        Kind kind = Kind::Create;
+        std::uint32_t componentType = 0;
+        ECS::Entity entity = 0;
+        void (*apply)(ECS::Registry &registry, ECS::Entity entity, void *payload) = nullptr;
+        void (*destroy)(void *payload) = nullptr;
+        alignas(std::max_align_t) std::array<std::byte, PayloadSize> payload{};
+    };
+
+    struct Chunk
+    {
+        static constexpr std::uint32_t Capacity = 256;
+
+        std::array<Command, Capacity> commands{};
+        std::atomic<std::uint32_t> used = 0;
+        std::atomic<Chunk *> next = nullptr;
+    };
+
+    Chunk *head;
+    std::atomic<Chunk *> tail;
+    std::atomic<std::uint32_t> placeholders = 0;
+    // Playback scratch, kept between frames
+    std::vector<ECS::Entity> createdEntities;
+    std::vector<ECS::Entity> destroyedEntities;
+    std::vector<Command *> componentCommands;
+    PlaybackObserver *observer = nullptr;
+    EntityCommandStats stats{};
+
+    static std::uint32_t NextComponentType();
+
+    template <typename T>
+    static std::uint32_t GetComponentType()
+    {
+        static const std::uint32_t type = NextComponentType();
+        return type;
+    }
+
+    /// A free slot, lock free for any number of recording threads.
+    Command &Reserve();
+
+    /// Placeholders to the entities created at playback, real ids stay as they are.
+    [[nodiscard]] ECS::Entity Resolve(ECS::Entity entity) const;
+
+    [[nodiscard]] bool IsDestroyed(ECS::Entity entity) const;
+
+    void ForEachCommand(auto &&function);
+
+  public:
+    EntityCommandBuffer();
+
+    EntityCommandBuffer(const EntityCommandBuffer &) = delete;
+
+    EntityCommandBuffer &operator=(const EntityCommandBuffer &) = delete;
+
+    ~EntityCommandBuffer();
+
+    /// Placeholder id of an entity created at playback.
+    ECS::Entity Create();
+
+    template <typename T>
+    EntityCommandBuffer &Add(const ECS::Entity entity, T component)
+    {
+        static_assert(sizeof(T) <= PayloadSize && alignof(T) <= alignof(std::max_align_t), "Component too big for a command");
+        Command &command = Reserve();
+        command.kind = Command::Kind::Add;
+        command.componentType = GetComponentType<T>();
+        command.entity = entity;
+        new (command.payload.data()) T(std::move(component));
+        command.apply = [](ECS::Registry &registry, const ECS::Entity target, void *payload)
+        { registry.AddComponent(target, std::move(*static_cast<T *>(payload))); };
+        command.destroy = [](void *payload) { static_cast<T *>(payload)->~T(); };
+        return *this;
+    }
+
+    template <typename T>
+    EntityCommandBuffer &Remove(const ECS::Entity entity)
+    {
+        Command &command = Reserve();
+        command.kind = Command::Kind::Remove;
+        command.componentType = GetComponentType<T>();
+        command.entity = entity;
+        command.apply = [](ECS::Registry &registry, const ECS::Entity target, [[maybe_unused]] void *payload) { registry.RemoveComponent<T>(target); };
+        command.destroy = nullptr;
+        return *this;
+    }
+
+    EntityCommandBuffer &Destroy(ECS::Entity entity);
+
+    /// Applies and forgets every recorded command, nobody may record meanwhile.
+    void Playback(ECS::Registry &registry);
+
+    /// Kept up to date by every playback, like the game's entity signatures.
+    void SetObserver(PlaybackObserver *playbackObserver);
+
+    /// Forgets the recorded commands, for when the registry they refer to was reset.
+    void Clear();
+
+    [[nodiscard]] bool IsEmpty() const;
+
+    /// Totals of the playbacks since the last ResetStats.
+    [[nodiscard]] const EntityCommandStats &GetStats() const;
+
+    void ResetStats();
+};
+
+#endif // PROYECTOFINAL_CGA_ENTITYCOMMANDBUFFER_H
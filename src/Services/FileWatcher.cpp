@@ -0,0 +1,195 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::~FileWatcher() { Stop(); }
+
+void FileWatcher::Add(const std::filesystem::path &path, PrepareFunction prepare)
+{
+    // "./shaders/" normalizes to "shaders/", its empty last element would never match a file under it
+    std::filesystem::path normalized = path.lexically_normal();
+    if (!normalized.has_filename() && normalized.has_relative_path()) normalized = normalized.parent_path();
+
+    std::error_code error;
+    watches.push_back({
+        .path = normalized,
+        .directory = std::filesystem::is_directory(path, error),
+        .prepare = std::move(prepare),
+    });
+}
+
+void FileWatcher::AddDirectoryWatch(const std::filesystem::path &directory, const bool recursive)
+{
+#if defined(__linux__)
+    constexpr uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+    const int wd = inotify_add_watch(inotifyFd, directory.c_str(), mask);
+    if (wd < 0)
+    {
+        std::cerr << "\033[33mCannot watch " << directory << "\033[0m\n";
+        return;
+    }
+    watchedDirectories[wd] = directory.lexically_normal();
+
+    if (!recursive) return;
+    std::error_code error;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(directory, error))
+    {
+        if (!entry.is_directory()) continue;
+        const int childWd = inotify_add_watch(inotifyFd, entry.path().c_str(), mask);
+        if (childWd >= 0) watchedDirectories[childWd] = entry.path().lexically_normal();
+    }
+#else
+    (void) directory;
+    (void) recursive;
+#endif
+}
+
+void FileWatcher::Start()
+{
+#if defined(__linux__)
+    if (thread.joinable()) return;
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd < 0 || wakeFd < 0)
+    {
+        std::cerr << "\033[31mCannot start the file watcher.\033[0m\n";
+        Stop();
+        return;
+    }
+
+    // inotify only reports direct children, single files are watched through their directory
+    for (const auto &watch : watches)
+    {
+        const std::filesystem::path parent = watch.path.has_parent_path() ? watch.path.parent_path() : ".";
+        AddDirectoryWatch(watch.directory ? watch.path : parent, watch.directory);
+    }
+
+    thread = std::thread(&FileWatcher::Run, this);
+#else
+    std::cout << "File watching is only available on Linux, hot reload is disabled.\n";
+#endif
+}
+
+void FileWatcher::Stop()
+{
+#if defined(__linux__)
+    if (thread.joinable())
+    {
+        constexpr uint64_t wake = 1;
+        [[maybe_unused]] const auto written = write(wakeFd, &wake, sizeof(wake));
+        thread.join();
+    }
+    if (inotifyFd >= 0) close(inotifyFd);
+    if (wakeFd >= 0) close(wakeFd);
+    inotifyFd = -1;
+    wakeFd = -1;
+#endif
+}
+
+void FileWatcher::ReadEvents()
+{
+#if defined(__linux__)
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char *cursor = buffer; cursor < buffer + length;)
+        {
+            const auto *event = reinterpret_cast<const inotify_event *>(cursor);
+            cursor += sizeof(inotify_event) + event->len;
+
+            const auto directory = watchedDirectories.find(event->wd);
+            if (directory == watchedDirectories.end() || event->len == 0) continue;
+
+            const std::filesystem::path path = (directory->second / event->name).lexically_normal();
+            if (event->mask & IN_ISDIR)
+            {
+                // New directories inside a recursive watch are watched as well
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) AddDirectoryWatch(path, true);
+                continue;
+            }
+
+            // Only complete writes, creating an empty file is followed by its IN_CLOSE_WRITE
+            if (event->mask & IN_CREATE) continue;
+            pendingEvents[path.string()] = std::chrono::steady_clock::now();
+        }
+    }
+#endif
+}
+
+void FileWatcher::DispatchSettled()
+{
+    const auto now = std::chrono::steady_clock::now();
+    for (auto it = pendingEvents.begin(); it != pendingEvents.end();)
+    {
+        if (now - it->second < Debounce)
+        {
+            ++it;
+            continue;
+        }
+
+        const std::filesystem::path path(it->first);
+        it = pendingEvents.erase(it);
+
+        for (const auto &watch : watches)
+        {
+            const bool matches = watch.directory
+                                     ? std::mismatch(watch.path.begin(), watch.path.end(), path.begin(), path.end()).first == watch.path.end()
+                                     : watch.path == path;
+            if (!matches) continue;
+
+            if (ApplyFunction apply = watch.prepare(path))
+            {
+                std::lock_guard lock(applyMutex);
+                applyQueue.push_back(std::move(apply));
+                hasPendingApply.store(true, std::memory_order_release);
+            }
+        }
+    }
+}
+
+void FileWatcher::Run()
+{
+#if defined(__linux__)
+    while (true)
+    {
+        pollfd fds[2] = {
+            {.fd = inotifyFd, .events = POLLIN, .revents = 0},
+            {.fd = wakeFd,    .events = POLLIN, .revents = 0},
+        };
+        // Sleep until something happens, wake up only to flush the debounced events
+        const int timeout = pendingEvents.empty() ? -1 : static_cast<int>(Debounce.count());
+        if (poll(fds, 2, timeout) < 0) continue;
+        if (fds[1].revents & POLLIN) return;
+
+        if (fds[0].revents & POLLIN) ReadEvents();
+        DispatchSettled();
+    }
+#endif
+}
+
+int FileWatcher::ApplyPending()
+{
+    if (!hasPendingApply.load(std::memory_order_acquire)) return 0;
+
+    std::vector<ApplyFunction> pending;
+    {
+        std::lock_guard lock(applyMutex);
+        pending.swap(applyQueue);
+        hasPendingApply.store(false, std::memory_order_relaxed);
+    }
+
+    for (const auto &apply : pending)
+        apply();
+    return static_cast<int>(pending.size());
+}
@@ -0,0 +1,79 @@
+#ifndef PROYECTOFINAL_CGA_FILEWATCHER_H
+#define PROYECTOFINAL_CGA_FILEWATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Watches files and directories with inotify on a background thread.
+ *
+ * Events are debounced per file. Once a file settles, the prepare function
+ * of its watch runs on the watcher thread (file reading, parsing) and may
+ * return an apply function, which is queued and run on the main thread by
+ * ApplyPending at the next frame boundary (GL work). Idle frames only pay for
+ * one atomic load. Only Linux is supported, elsewhere Start does nothing.
+ */
+class FileWatcher
+{
+  public:
+    using ApplyFunction = std::function<void()>;
+    using PrepareFunction = std::function<ApplyFunction(const std::filesystem::path &)>;
+
+  private:
+    struct Watch
+    {
+        std::filesystem::path path;
+        bool directory = false;
+        PrepareFunction prepare;
+    };
+
+    static constexpr auto Debounce = std::chrono::milliseconds(200);
+
+    std::vector<Watch> watches;
+    std::unordered_map<int, std::filesystem::path> watchedDirectories;
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> pendingEvents;
+
+    std::mutex applyMutex;
+    std::vector<ApplyFunction> applyQueue;
+    std::atomic<bool> hasPendingApply = false;
+
+    std::thread thread;
+    int inotifyFd = -1;
+    int wakeFd = -1;
+
+    void AddDirectoryWatch(const std::filesystem::path &directory, bool recursive);
+
+    void ReadEvents();
+
+    void DispatchSettled();
+
+    void Run();
+
+  public:
+    FileWatcher() = default;
+
+    FileWatcher(const FileWatcher &) = delete;
+
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    ~FileWatcher();
+
+    /// Watches a file, or every file under a directory. Must be called before Start.
+    void Add(const std::filesystem::path &path, PrepareFunction prepare);
+
+    void Start();
+
+    void Stop();
+
+    /// Runs the apply functions of the files that changed, returns how many ran.
+    int ApplyPending();
+};
+
+#endif // PROYECTOFINAL_CGA_FILEWATCHER_H
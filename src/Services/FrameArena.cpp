@@ -0,0 +1,44 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(const std::size_t capacity) : memory(std::make_unique_for_overwrite<std::byte[]>(capacity)), capacity(capacity) {}
+
+void *FrameArena::Allocate(const std::size_t size, const std::size_t alignment)
+{
+    const auto base = reinterpret_cast<std::uintptr_t>(memory.get());
+    const std::size_t aligned = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+    if (aligned + size <= capacity)
+    {
+        offset = aligned + size;
+        return memory.get() + aligned;
+    }
+
+    // new[] is aligned for any fundamental type, larger alignments get padding
+    overflowBlocks.push_back(std::make_unique_for_overwrite<std::byte[]>(size + alignment));
+    overflowBytes += size + alignment;
+    const auto block = reinterpret_cast<std::uintptr_t>(overflowBlocks.back().get());
+    return reinterpret_cast<void *>((block + alignment - 1) & ~(alignment - 1));
+}
+
+void FrameArena::Reset()
+{
+    lastFrameBytes = offset + overflowBytes;
+    if (!overflowBlocks.empty())
+    {
+        overflows++;
+        overflowBlocks.clear();
+        // Room for the whole frame that overflowed, with some margin
+        capacity = std::max(capacity * 2, lastFrameBytes + lastFrameBytes / 2);
+        memory = std::make_unique_for_overwrite<std::byte[]>(capacity);
+    }
+    offset = 0;
+    overflowBytes = 0;
+}
+
+std::size_t FrameArena::GetCapacity() const { return capacity; }
+
+std::size_t FrameArena::GetLastFrameBytes() const { return lastFrameBytes; }
+
+std::size_t FrameArena::GetOverflowCount() const { return overflows; }
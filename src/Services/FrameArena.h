@@ -0,0 +1,82 @@
+#ifndef PROYECTOFINAL_CGA_FRAMEARENA_H
+#define PROYECTOFINAL_CGA_FRAMEARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * Linear allocator for the temporaries of one frame.
+ *
+ * Allocating moves a pointer forward and freeing does nothing, everything is
+ * released at once by Reset at the end of the frame. A frame that does not
+ * fit gets extra blocks from the heap, the next Reset replaces them with a
+ * single block big enough for that frame, so a steady frame stops touching
+ * the heap after the first few.
+ */
+class FrameArena
+{
+    std::unique_ptr<std::byte[]> memory;
+    std::size_t capacity = 0;
+    std::size_t offset = 0;
+    std::vector<std::unique_ptr<std::byte[]>> overflowBlocks;
+    std::size_t overflowBytes = 0;
+    std::size_t lastFrameBytes = 0;
+    std::size_t overflows = 0;
+
+  public:
+    explicit FrameArena(std::size_t capacity);
+
+    FrameArena(const FrameArena &) = delete;
+
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    [[nodiscard]] void *Allocate(std::size_t size, std::size_t alignment);
+
+    /// Releases every allocation of the frame, nothing allocated before may be used after it.
+    void Reset();
+
+    [[nodiscard]] std::size_t GetCapacity() const;
+
+    /// Bytes allocated in the last complete frame, padding included.
+    [[nodiscard]] std::size_t GetLastFrameBytes() const;
+
+    /// Frames that did not fit in the arena since it was created.
+    [[nodiscard]] std::size_t GetOverflowCount() const;
+};
+
+/// Standard allocator over a FrameArena, deallocate is a no-op.
+template <typename T>
+class ArenaAllocator
+{
+    template <typename U>
+    friend class ArenaAllocator;
+
+    FrameArena *arena;
+
+  public:
+    using value_type = T;
+
+    explicit ArenaAllocator(FrameArena &arena) : arena(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) // NOLINT(*-explicit-constructor)
+    {
+    }
+
+    [[nodiscard]] T *allocate(const std::size_t count) { return static_cast<T *>(arena->Allocate(count * sizeof(T), alignof(T))); }
+
+    void deallocate([[maybe_unused]] T *pointer, [[maybe_unused]] std::size_t count) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const
+    {
+        return arena == other.arena;
+    }
+};
+
+/// Vector of the current frame, it must not outlive the arena's next Reset.
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif // PROYECTOFINAL_CGA_FRAMEARENA_H
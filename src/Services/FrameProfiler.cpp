@@ -0,0 +1,47 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+
+std::size_t FrameProfiler::GetIndex(const std::string_view name)
+{
+    const auto it = std::ranges::find(names, name);
+    if (it != names.end()) return static_cast<std::size_t>(it - names.begin());
+
+    names.emplace_back(name);
+    current.push_back(0.0f);
+    last.push_back(0.0f);
+    return names.size() - 1;
+}
+
+void FrameProfiler::BeginFrame()
+{
+    std::ranges::fill(current, 0.0f);
+    open.clear();
+    frameStart = Clock::now();
+}
+
+void FrameProfiler::EndFrame()
+{
+    while (!open.empty())
+        End();
+    lastFrameMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - frameStart).count();
+    last = current;
+}
+
+void FrameProfiler::Begin(const std::string_view name) { open.emplace_back(GetIndex(name), Clock::now()); }
+
+void FrameProfiler::End()
+{
+    if (open.empty()) return;
+    const auto [index, start] = open.back();
+    open.pop_back();
+    current[index] += std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+}
+
+void FrameProfiler::Record(const std::string_view name, const float milliseconds) { current[GetIndex(name)] += milliseconds; }
+
+const std::vector<std::string> &FrameProfiler::GetNames() const { return names; }
+
+const std::vector<float> &FrameProfiler::GetLastFrame() const { return last; }
+
+float FrameProfiler::GetLastFrameMilliseconds() const { return lastFrameMilliseconds; }
@@ -0,0 +1,51 @@
+#ifndef PROYECTOFINAL_CGA_FRAMEPROFILER_H
+#define PROYECTOFINAL_CGA_FRAMEPROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * CPU time per named section of the frame.
+ *
+ * Sections are opened with Begin and closed with End in stack order, a name
+ * used again in the same frame adds to its time. The times of the last
+ * complete frame stay available until the next EndFrame.
+ */
+class FrameProfiler
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<std::string> names;
+    std::vector<float> current;
+    std::vector<float> last;
+    std::vector<std::pair<std::size_t, Clock::time_point>> open;
+    Clock::time_point frameStart;
+    float lastFrameMilliseconds = 0.0f;
+
+    std::size_t GetIndex(std::string_view name);
+
+  public:
+    void BeginFrame();
+
+    void EndFrame();
+
+    void Begin(std::string_view name);
+
+    void End();
+
+    /// Adds a time measured elsewhere (e.g. the GPU timer) to this frame.
+    void Record(std::string_view name, float milliseconds);
+
+    [[nodiscard]] const std::vector<std::string> &GetNames() const;
+
+    /// Milliseconds of each section in the last frame, same order as GetNames.
+    [[nodiscard]] const std::vector<float> &GetLastFrame() const;
+
+    [[nodiscard]] float GetLastFrameMilliseconds() const;
+};
+
+#endif // PROYECTOFINAL_CGA_FRAMEPROFILER_H
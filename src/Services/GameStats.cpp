@@ -0,0 +1,38 @@
+#include "GameStats.h"
+
+namespace
+{
+constexpr std::array<const char *, GameStats::StatCount> StatNames = {
+    "Paths spawned", "Paths culled", "Obstacles spawned", "Obstacles culled", "Obstacles hit", "Coins spawned",
+    "Coins culled", "Coins collected", "Buildings spawned", "Buildings culled", "Player contacts"};
+} // namespace
+
+GameStats *GameStats::GetInstance()
+{
+    static GameStats instance;
+    return &instance;
+}
+
+void GameStats::Add(const GameStat stat, const std::uint64_t amount) { counters[static_cast<std::size_t>(stat)] += amount; }
+
+std::uint64_t GameStats::Get(const GameStat stat) const { return counters[static_cast<std::size_t>(stat)]; }
+
+GamePopulation GameStats::GetPopulation() const
+{
+    // An entity culled and hit in the same frame is counted as removed twice, the count stops at 0 instead of wrapping
+    const auto remaining = [](const std::uint64_t spawned, const std::uint64_t removed) -> std::uint64_t { return spawned > removed ? spawned - removed : 0; };
+    return {
+        .paths = remaining(Get(GameStat::PathsSpawned), Get(GameStat::PathsCulled)),
+        .obstacles = remaining(Get(GameStat::ObstaclesSpawned), Get(GameStat::ObstaclesCulled) + Get(GameStat::ObstaclesHit)),
+        .coins = remaining(Get(GameStat::CoinsSpawned), Get(GameStat::CoinsCulled) + Get(GameStat::CoinsCollected)),
+        .buildings = remaining(Get(GameStat::BuildingsSpawned), Get(GameStat::BuildingsCulled)),
+    };
+}
+
+const GameStats::Counters &GameStats::GetCounters() const { return counters; }
+
+void GameStats::SetCounters(const Counters &values) { counters = values; }
+
+void GameStats::Reset() { counters = {}; }
+
+const char *GameStats::GetStatName(const GameStat stat) { return StatNames[static_cast<std::size_t>(stat)]; }
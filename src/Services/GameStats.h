@@ -0,0 +1,70 @@
+#ifndef PROYECTOFINAL_CGA_GAMESTATS_H
+#define PROYECTOFINAL_CGA_GAMESTATS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+enum class GameStat : std::uint8_t
+{
+    PathsSpawned,
+    PathsCulled,
+    ObstaclesSpawned,
+    ObstaclesCulled,
+    ObstaclesHit,
+    CoinsSpawned,
+    CoinsCulled,
+    CoinsCollected,
+    BuildingsSpawned,
+    BuildingsCulled,
+    /// Contacts of the player, counted once per update by the RunnerSystem.
+    PlayerContacts,
+    Count
+};
+
+/// Entities of each kind in the run, from the counters instead of a registry query.
+struct GamePopulation
+{
+    std::uint64_t paths = 0;
+    std::uint64_t obstacles = 0;
+    std::uint64_t coins = 0;
+    std::uint64_t buildings = 0;
+};
+
+/**
+ * Counters of the run, incremented by the systems and the game logic where
+ * things happen so the HUD and the debug panel never scan the registry.
+ *
+ * The counters are part of the game snapshots, a restored run gets the
+ * counts of the moment it was captured.
+ */
+class GameStats
+{
+  public:
+    static constexpr auto StatCount = static_cast<std::size_t>(GameStat::Count);
+    using Counters = std::array<std::uint64_t, StatCount>;
+
+  private:
+    Counters counters{};
+
+    GameStats() = default;
+
+  public:
+    static GameStats *GetInstance();
+
+    void Add(GameStat stat, std::uint64_t amount = 1);
+
+    [[nodiscard]] std::uint64_t Get(GameStat stat) const;
+
+    [[nodiscard]] GamePopulation GetPopulation() const;
+
+    [[nodiscard]] const Counters &GetCounters() const;
+
+    void SetCounters(const Counters &values);
+
+    void Reset();
+
+    static const char *GetStatName(GameStat stat);
+};
+
+#endif // PROYECTOFINAL_CGA_GAMESTATS_H
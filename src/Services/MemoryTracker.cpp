@@ -0,0 +1,122 @@
+#include "MemoryTracker.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <format>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+constexpr auto TagCount = static_cast<std::size_t>(MemoryTag::Count);
+
+constexpr std::array<const char *, TagCount> TagNames = {"General", "Registry", "Models", "Textures", "Particles", "Rendering", "Gui"};
+
+struct TagCounters
+{
+    // Written by the allocation hooks of every thread
+    std::atomic<std::size_t> liveBytes = 0;
+    std::atomic<std::size_t> peakBytes = 0;
+    std::atomic<std::uint64_t> allocations = 0;
+    std::atomic<std::uint64_t> frameAllocations = 0;
+    // Main thread only
+    std::uint64_t lastFrameAllocations = 0;
+    std::uint64_t maxFrameAllocations = 0;
+    std::size_t budget = 0;
+    bool overBudget = false;
+};
+
+std::array<TagCounters, TagCount> counters;
+thread_local MemoryTag currentTag = MemoryTag::General;
+
+TagCounters &GetCounters(const MemoryTag tag) { return counters[static_cast<std::size_t>(tag)]; }
+
+double ToMegabytes(const std::size_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); }
+} // namespace
+
+MemoryTag MemoryTracker::GetCurrentTag() { return currentTag; }
+
+void MemoryTracker::SetCurrentTag(const MemoryTag tag) { currentTag = tag; }
+
+void MemoryTracker::RecordAllocation(const MemoryTag tag, const std::size_t size)
+{
+    TagCounters &tagCounters = GetCounters(tag);
+    tagCounters.allocations.fetch_add(1, std::memory_order_relaxed);
+    tagCounters.frameAllocations.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t live = tagCounters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    std::size_t peak = tagCounters.peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !tagCounters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+    {
+    }
+}
+
+void MemoryTracker::RecordFree(const MemoryTag tag, const std::size_t size) { GetCounters(tag).liveBytes.fetch_sub(size, std::memory_order_relaxed); }
+
+void MemoryTracker::SetBudget(const MemoryTag tag, const std::size_t bytes) { GetCounters(tag).budget = bytes; }
+
+void MemoryTracker::EndFrame()
+{
+    if constexpr (!Enabled) return;
+
+    for (std::size_t i = 0; i < TagCount; i++)
+    {
+        TagCounters &tagCounters = counters[i];
+        tagCounters.lastFrameAllocations = tagCounters.frameAllocations.exchange(0, std::memory_order_relaxed);
+        tagCounters.maxFrameAllocations = std::max(tagCounters.maxFrameAllocations, tagCounters.lastFrameAllocations);
+
+        // Warns once when the budget is crossed, again only after going back under it
+        const std::size_t live = tagCounters.liveBytes.load(std::memory_order_relaxed);
+        const bool overBudget = tagCounters.budget != 0 && live > tagCounters.budget;
+        if (overBudget && !tagCounters.overBudget)
+            std::cerr << std::format("\033[33mMemory budget of {} exceeded: {:.2f} MB of {:.2f} MB\033[0m\n", TagNames[i], ToMegabytes(live),
+                                     ToMegabytes(tagCounters.budget));
+        tagCounters.overBudget = overBudget;
+    }
+}
+
+MemoryTagStats MemoryTracker::GetStats(const MemoryTag tag)
+{
+    const TagCounters &tagCounters = GetCounters(tag);
+    return {
+        .liveBytes = tagCounters.liveBytes.load(std::memory_order_relaxed),
+        .peakBytes = tagCounters.peakBytes.load(std::memory_order_relaxed),
+        .allocations = tagCounters.allocations.load(std::memory_order_relaxed),
+        .frameAllocations = tagCounters.lastFrameAllocations,
+        .maxFrameAllocations = tagCounters.maxFrameAllocations,
+        .budget = tagCounters.budget,
+    };
+}
+
+const char *MemoryTracker::GetTagName(const MemoryTag tag) { return TagNames[static_cast<std::size_t>(tag)]; }
+
+bool MemoryTracker::WriteReport(const std::filesystem::path &path)
+{
+    nlohmann::json tags = nlohmann::json::object();
+    for (std::size_t i = 0; i < TagCount; i++)
+    {
+        const MemoryTagStats stats = GetStats(static_cast<MemoryTag>(i));
+        tags[TagNames[i]] = {
+            {"live_bytes", stats.liveBytes},
+            {"peak_bytes", stats.peakBytes},
+            {"allocations", stats.allocations},
+            {"max_frame_allocations", stats.maxFrameAllocations},
+            {"budget", stats.budget},
+        };
+    }
+
+    std::ofstream stream(path);
+    if (!stream.is_open())
+    {
+        std::cerr << "\033[31mCannot write the memory report to " << path << "\033[0m\n";
+        return false;
+    }
+    stream << nlohmann::json{
+        {"tracking", Enabled},
+        {"tags", tags},
+    }.dump(2);
+    std::cout << "Memory report written to " << path << '\n';
+    return true;
+}
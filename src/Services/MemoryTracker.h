@@ -0,0 +1,123 @@
+#ifndef PROYECTOFINAL_CGA_MEMORYTRACKER_H
+#define PROYECTOFINAL_CGA_MEMORYTRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <new>
+
+/// Subsystem an allocation is charged to.
+enum class MemoryTag : std::uint8_t
+{
+    General,
+    Registry,
+    Models,
+    Textures,
+    Particles,
+    Rendering,
+    Gui,
+    Count
+};
+
+struct MemoryTagStats
+{
+    std::size_t liveBytes = 0;
+    std::size_t peakBytes = 0;
+    std::uint64_t allocations = 0;
+    /// Allocations in the last complete frame, and the most seen in one frame.
+    std::uint64_t frameAllocations = 0;
+    std::uint64_t maxFrameAllocations = 0;
+    /// 0 when the tag has no budget.
+    std::size_t budget = 0;
+};
+
+/**
+ * Heap use per subsystem, only recorded when built with ENABLE_MEMORY_TRACKING.
+ *
+ * The replaced global operator new (AllocationCounter.cpp) charges every
+ * allocation to the tag of the innermost MemoryTagScope of its thread and
+ * keeps the size and tag in front of the block, so the delete takes the
+ * bytes back from the same tag. Without the define nothing is recorded and
+ * the stats stay at zero.
+ */
+namespace MemoryTracker
+{
+#ifdef ENABLE_MEMORY_TRACKING
+constexpr bool Enabled = true;
+#else
+constexpr bool Enabled = false;
+#endif
+
+MemoryTag GetCurrentTag();
+
+void SetCurrentTag(MemoryTag tag);
+
+/// Called by the allocation hooks, they cannot allocate.
+void RecordAllocation(MemoryTag tag, std::size_t size);
+
+void RecordFree(MemoryTag tag, std::size_t size);
+
+/// Live bytes above which EndFrame warns, 0 removes the budget.
+void SetBudget(MemoryTag tag, std::size_t bytes);
+
+/// Closes the allocation counts of the frame and warns once for every tag that went over its budget.
+void EndFrame();
+
+MemoryTagStats GetStats(MemoryTag tag);
+
+const char *GetTagName(MemoryTag tag);
+
+bool WriteReport(const std::filesystem::path &path);
+} // namespace MemoryTracker
+
+/// Charges the allocations of the current thread to a tag until the scope ends.
+class MemoryTagScope
+{
+    MemoryTag previous;
+
+  public:
+    explicit MemoryTagScope(const MemoryTag tag) : previous(MemoryTracker::GetCurrentTag()) { MemoryTracker::SetCurrentTag(tag); }
+
+    MemoryTagScope(const MemoryTagScope &) = delete;
+
+    MemoryTagScope &operator=(const MemoryTagScope &) = delete;
+
+    ~MemoryTagScope() { MemoryTracker::SetCurrentTag(previous); }
+};
+
+/// Standard allocator that charges a container's storage to a tag, wherever the container is used.
+template <typename T, MemoryTag Tag>
+class TaggedAllocator
+{
+  public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = TaggedAllocator<U, Tag>;
+    };
+
+    TaggedAllocator() = default;
+
+    template <typename U>
+    TaggedAllocator([[maybe_unused]] const TaggedAllocator<U, Tag> &other) // NOLINT(*-explicit-constructor)
+    {
+    }
+
+    [[nodiscard]] T *allocate(const std::size_t count)
+    {
+        const MemoryTagScope scope(Tag);
+        return static_cast<T *>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T *pointer, [[maybe_unused]] std::size_t count) { ::operator delete(pointer); }
+
+    template <typename U>
+    bool operator==([[maybe_unused]] const TaggedAllocator<U, Tag> &other) const
+    {
+        return true;
+    }
+};
+
+#endif // PROYECTOFINAL_CGA_MEMORYTRACKER_H
@@ -0,0 +1,124 @@
+#ifndef PROYECTOFINAL_CGA_REGISTRYSNAPSHOT_H
+#define PROYECTOFINAL_CGA_REGISTRYSNAPSHOT_H
+
+#include "../Components/ParentComponent.h"
+#include "ECS/Components/Collider.h"
+#include "ECS/Registry.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/// Captured entity id to the id it got when the snapshot was restored.
+struct EntityRemap
+{
+    static constexpr ECS::Entity Invalid = std::numeric_limits<ECS::Entity>::max();
+
+    std::vector<ECS::Entity> ids;
+
+    ECS::Entity operator()(const ECS::Entity captured) const { return captured < ids.size() ? ids[captured] : Invalid; }
+};
+
+/// Fixes the entity ids stored inside a component after a restore, nothing to do for most of them.
+template <typename T>
+struct SnapshotTraits
+{
+    static void Remap([[maybe_unused]] T &component, [[maybe_unused]] const EntityRemap &remap) {}
+};
+
+template <>
+struct SnapshotTraits<ParentComponent>
+{
+    static void Remap(ParentComponent &component, const EntityRemap &remap) { component.parent = remap(component.parent); }
+};
+
+template <>
+struct SnapshotTraits<ECS::Components::AABBCollider>
+{
+    // The contacts are found again by the next collision update
+    static void Remap(ECS::Components::AABBCollider &component, [[maybe_unused]] const EntityRemap &remap)
+    {
+        component.isColliding = false;
+        component.collidingEntities.clear();
+    }
+};
+
+/**
+ * Copy of every listed component of every entity, restored into an empty registry.
+ *
+ * Each component type is kept in its own dense array next to the ids of its
+ * owners, so capturing is one pass per pool and the arrays keep their capacity
+ * between captures. The engine registry only exposes per entity access, a
+ * restore resets it and adds the components back one by one. Entities are
+ * recreated in id order and the ids stored inside components are remapped.
+ */
+template <typename... Components>
+class RegistrySnapshot
+{
+    template <typename T>
+    struct Pool
+    {
+        std::vector<ECS::Entity> owners;
+        std::vector<T> components;
+    };
+
+    std::vector<ECS::Entity> entities;
+    std::tuple<Pool<Components>...> pools;
+    bool captured = false;
+
+    template <typename T>
+    void CapturePool(ECS::Registry &registry)
+    {
+        auto &[owners, components] = std::get<Pool<T>>(pools);
+        owners = registry.View<T>();
+        components.clear();
+        components.reserve(owners.size());
+        for (const ECS::Entity entity : owners)
+            components.push_back(registry.GetComponent<T>(entity));
+        entities.insert(entities.end(), owners.begin(), owners.end());
+    }
+
+    template <typename T>
+    void RestorePool(ECS::Registry &registry, const EntityRemap &remap) const
+    {
+        const auto &[owners, components] = std::get<Pool<T>>(pools);
+        for (std::size_t i = 0; i < owners.size(); i++)
+        {
+            T component = components[i];
+            SnapshotTraits<T>::Remap(component, remap);
+            registry.AddComponent(remap(owners[i]), std::move(component));
+        }
+    }
+
+  public:
+    void Capture(ECS::Registry &registry)
+    {
+        entities.clear();
+        (CapturePool<Components>(registry), ...);
+        std::ranges::sort(entities);
+        const auto duplicates = std::ranges::unique(entities);
+        entities.erase(duplicates.begin(), duplicates.end());
+        captured = true;
+    }
+
+    /// Resets the registry and recreates the captured entities, the remap gives their new ids.
+    EntityRemap Restore(ECS::Registry &registry) const
+    {
+        registry.Reset();
+        EntityRemap remap;
+        if (!entities.empty()) remap.ids.assign(entities.back() + 1, EntityRemap::Invalid);
+        for (const ECS::Entity entity : entities)
+            remap.ids[entity] = registry.CreateEntity();
+        (RestorePool<Components>(registry, remap), ...);
+        return remap;
+    }
+
+    [[nodiscard]] bool IsCaptured() const { return captured; }
+
+    [[nodiscard]] std::size_t GetEntityCount() const { return entities.size(); }
+};
+
+#endif // PROYECTOFINAL_CGA_REGISTRYSNAPSHOT_H
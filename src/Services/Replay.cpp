@@ -0,0 +1,144 @@
+#include "Replay.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+void Replay::StartRecording(const std::filesystem::path &file, const std::uint32_t randomSeed)
+{
+    mode = Mode::Recording;
+    path = file;
+    seed = randomSeed;
+    ticks.clear();
+}
+
+bool Replay::StartPlayback(const std::filesystem::path &file)
+{
+    std::ifstream stream(file);
+    if (!stream.is_open())
+    {
+        std::cerr << "\033[31mCannot open the replay " << file << "\033[0m\n";
+        return false;
+    }
+
+    const nlohmann::json data = nlohmann::json::parse(stream, nullptr, false);
+    if (data.is_discarded() || !data.contains("version") || !data.contains("ticks") || data.at("version").get<int>() != FormatVersion)
+    {
+        std::cerr << "\033[31mThe replay " << file << " is not a version " << FormatVersion << " recording\033[0m\n";
+        return false;
+    }
+
+    seed = data.at("seed").get<std::uint32_t>();
+    ticks.clear();
+    for (const auto &tick : data.at("ticks"))
+    {
+        // [deltaTime, heldMask] followed by one press count per action when something was pressed
+        ReplayTick &replayTick = ticks.emplace_back();
+        replayTick.deltaTime = tick[0].get<float>();
+        replayTick.heldMask = tick[1].get<std::uint32_t>();
+        for (std::size_t i = 0; i + 2 < tick.size() && i < replayTick.presses.size(); i++)
+            replayTick.presses[i] = tick[i + 2].get<int>();
+    }
+
+    mode = Mode::Playing;
+    path = file;
+    cursor = 0;
+    frameTimes.clear();
+    frameTimes.reserve(ticks.size());
+    return true;
+}
+
+float Replay::Tick(ActionQueue &actions, const float deltaTime)
+{
+    if (mode == Mode::Recording)
+    {
+        ticks.push_back({.deltaTime = deltaTime, .heldMask = actions.GetHeldMask(), .presses = actions.GetPressCounts()});
+        return deltaTime;
+    }
+
+    if (mode != Mode::Playing || IsFinished()) return deltaTime;
+
+    // The first frame also measures the loading time
+    if (cursor > 0) frameTimes.push_back(deltaTime * 1000.0f);
+
+    const ReplayTick &tick = ticks[cursor++];
+    actions.Override(tick.presses, tick.heldMask);
+    return tick.deltaTime;
+}
+
+bool Replay::Save() const
+{
+    if (mode != Mode::Recording) return true;
+
+    nlohmann::json ticksData = nlohmann::json::array();
+    for (const auto &tick : ticks)
+    {
+        nlohmann::json tickData = nlohmann::json::array();
+        tickData.push_back(tick.deltaTime);
+        tickData.push_back(tick.heldMask);
+        if (std::ranges::any_of(tick.presses, [](const int count) -> bool { return count != 0; }))
+            for (const int count : tick.presses)
+                tickData.push_back(count);
+        ticksData.push_back(tickData);
+    }
+
+    std::ofstream stream(path);
+    if (!stream.is_open())
+    {
+        std::cerr << "\033[31mCannot write the replay " << path << "\033[0m\n";
+        return false;
+    }
+    stream << nlohmann::json{
+        {"version", FormatVersion},
+        {"seed", seed},
+        {"ticks", ticksData},
+    }.dump();
+    std::cout << "Recorded " << ticks.size() << " ticks to " << path << '\n';
+    return true;
+}
+
+Replay::Mode Replay::GetMode() const { return mode; }
+
+std::uint32_t Replay::GetSeed() const { return seed; }
+
+bool Replay::IsFinished() const { return mode == Mode::Playing && cursor >= ticks.size(); }
+
+FrameTimeSummary Replay::Summarize() const
+{
+    FrameTimeSummary summary{.frames = frameTimes.size()};
+    if (frameTimes.empty()) return summary;
+
+    std::vector<float> sorted = frameTimes;
+    std::ranges::sort(sorted);
+    // Nearest rank percentile
+    const auto percentile = [&sorted](const float p) -> float
+    {
+        const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<float>(sorted.size())));
+        return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+    };
+    summary.p50 = percentile(0.50f);
+    summary.p95 = percentile(0.95f);
+    summary.p99 = percentile(0.99f);
+    summary.worst = sorted.back();
+    return summary;
+}
+
+std::uint64_t Replay::HashState(const std::span<const float> values)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const float value : values)
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 4; i++)
+        {
+            hash ^= (bits >> (i * 8)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
@@ -0,0 +1,86 @@
+#ifndef PROYECTOFINAL_CGA_REPLAY_H
+#define PROYECTOFINAL_CGA_REPLAY_H
+
+#include "ActionQueue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+struct ReplayTick
+{
+    float deltaTime = 0.0f;
+    std::uint32_t heldMask = 0;
+    ActionQueue::PressCounts presses{};
+};
+
+struct FrameTimeSummary
+{
+    std::size_t frames = 0;
+    float p50 = 0.0f;
+    float p95 = 0.0f;
+    float p99 = 0.0f;
+    float worst = 0.0f;
+};
+
+/**
+ * Records a session (RNG seed, per tick actions and delta time) and plays it
+ * back.
+ *
+ * While playing, the live input is replaced with the recorded actions and the
+ * simulation advances with the recorded delta times, so the game ends in the
+ * same state no matter how long each frame really took. The real frame times
+ * are collected for the regression report.
+ */
+class Replay
+{
+  public:
+    enum class Mode : std::uint8_t
+    {
+        Off,
+        Recording,
+        Playing
+    };
+
+  private:
+    static constexpr int FormatVersion = 1;
+
+    Mode mode = Mode::Off;
+    std::filesystem::path path;
+    std::uint32_t seed = 0;
+    std::vector<ReplayTick> ticks;
+    std::size_t cursor = 0;
+    std::vector<float> frameTimes;
+
+  public:
+    void StartRecording(const std::filesystem::path &file, std::uint32_t randomSeed);
+
+    /// Loads a recording and starts playing it, returns false if the file cannot be read.
+    bool StartPlayback(const std::filesystem::path &file);
+
+    /**
+     * Called once per frame after the actions are polled. Records them or, when playing,
+     * overrides them and returns the recorded delta time instead of the measured one.
+     */
+    float Tick(ActionQueue &actions, float deltaTime);
+
+    /// Writes the recording, nothing to do in the other modes.
+    bool Save() const;
+
+    [[nodiscard]] Mode GetMode() const;
+
+    [[nodiscard]] std::uint32_t GetSeed() const;
+
+    /// True once every recorded tick has been played.
+    [[nodiscard]] bool IsFinished() const;
+
+    /// Percentiles of the real frame times measured during playback, in milliseconds.
+    [[nodiscard]] FrameTimeSummary Summarize() const;
+
+    /// FNV-1a over the raw bits of the values, the same state always gives the same hash.
+    static std::uint64_t HashState(std::span<const float> values);
+};
+
+#endif // PROYECTOFINAL_CGA_REPLAY_H
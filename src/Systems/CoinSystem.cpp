@@ -1,27 +1,32 @@
 #include "CoinSystem.h"
 #include "../Components/CoinComponent.h"
+#include "../Components/ParticleEmitterComponent.h"
 #include "../Components/RunnerComponent.h"
+#include "../Services/EntityCommandBuffer.h"
+#include "../Services/GameStats.h"
 #include "ECS/Components/AudioSource.h"
 #include "ECS/Components/Collider.h"
 #include <AL/al.h>
-#include <GLFW/glfw3.h>
 
-void CoinSystem::Update(ECS::Registry &registry, [[maybe_unused]] float dt)
+void CoinSystem::Update(ECS::Registry &registry, const float dt)
 {
-    const auto playerView = registry.View<RunnerComponent>();
-    if (playerView.empty())
+    // From the fixed steps instead of the wall clock, a replay spins the coins the same way
+    time += dt;
+    if (!commands || player == RunnerSystem::NoPlayer)
     {
         return;
     }
-    const ECS::Entity player = playerView.front();
+    const auto stats = GameStats::GetInstance();
     auto &playerCollider = registry.GetComponent<ECS::Components::AABBCollider>(player);
 
     for (auto entity : registry.View<CoinComponent, ECS::Components::Transform>())
     {
         auto &transform = registry.GetComponent<ECS::Components::Transform>(entity);
-        transform.rotation = glm::quat_cast(glm::rotate(glm::mat4(1.0f), glm::radians(static_cast<float>(glfwGetTime()) * 250.0f), {0, 1, 0}));
+        transform.rotation = glm::quat_cast(glm::rotate(glm::mat4(1.0f), glm::radians(time * 250.0f), {0, 1, 0}));
 
-        if (playerCollider.isColliding && (std::ranges::find(playerCollider.collidingEntities, entity) != playerCollider.collidingEntities.end()))
+        if (!playerCollider.isColliding) continue;
+
+        if (std::ranges::find(playerCollider.collidingEntities, entity) != playerCollider.collidingEntities.end())
         {
             auto &runner = registry.GetComponent<RunnerComponent>(player);
             auto &[value] = registry.GetComponent<CoinComponent>(entity);
@@ -38,7 +43,16 @@ void CoinSystem::Update(ECS::Registry &registry, [[maybe_unused]] float dt)
                 audioSource.isDirty = true;
             }
 
-            registry.DestroyEntity(entity);
+            const ECS::Entity sparkle = commands->Create();
+            commands->Add(sparkle, ECS::Components::Transform{.translation = transform.translation})
+                .Add(sparkle, ParticleEmitterComponent{.effect = ParticleEffect::CoinSparkle, .burst = 32});
+
+            commands->Destroy(entity);
+            stats->Add(GameStat::CoinsCollected);
         }
     }
 }
+
+void CoinSystem::SetCommandBuffer(EntityCommandBuffer *buffer) { commands = buffer; }
+
+void CoinSystem::SetPlayer(const ECS::Entity entity) { player = entity; }
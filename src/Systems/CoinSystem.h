@@ -2,10 +2,22 @@
 #define COINSYSTEM_H
 
 #include "ECS/ISystem.h"
+#include "RunnerSystem.h"
+
+class EntityCommandBuffer;
 
 class CoinSystem final : public ECS::ISystem {
+    EntityCommandBuffer *commands = nullptr;
+    ECS::Entity player = RunnerSystem::NoPlayer;
+    float time = 0.0f;
 public:
     void Update(ECS::Registry& registry, float dt) override;
+
+    /// Collected coins and their sparkles are created and destroyed through it, the system does nothing without one.
+    void SetCommandBuffer(EntityCommandBuffer *buffer);
+
+    /// Same handle as the RunnerSystem's, no coin is collected without a player.
+    void SetPlayer(ECS::Entity entity);
 };
 
 #endif //COINSYSTEM_H
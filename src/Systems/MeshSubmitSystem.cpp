@@ -0,0 +1,89 @@
+#include "GlobalDefines.h"
+
+#include "MeshSubmitSystem.h"
+
+#include "../Components/LodComponent.h"
+#include "../Rendering/LodLibrary.h"
+#include "../Rendering/RenderQueue.h"
+#include "TransformCacheSystem.h"
+#include "ECS/Components/MeshRenderer.h"
+#include "ECS/Components/Transform.h"
+
+#include <algorithm>
+
+void MeshSubmitSystem::Update(ECS::Registry &registry, [[maybe_unused]] float deltaTime)
+{
+    lodStats = {};
+    if (!renderQueue || !signatures) return;
+
+    for (const ECS::Entity entity :
+         GameQuery<ECS::Components::MeshRenderer, ECS::Components::Transform, Exclude<LodComponent>>::View(registry, *signatures))
+    {
+        const auto &meshRenderer = registry.GetComponent<ECS::Components::MeshRenderer>(entity);
+        if (!meshRenderer.model || !meshRenderer.shader) continue;
+        Submit(registry, entity, meshRenderer, *meshRenderer.model);
+    }
+
+    for (const ECS::Entity entity : GameQuery<ECS::Components::MeshRenderer, ECS::Components::Transform, LodComponent>::View(registry))
+    {
+        const auto &meshRenderer = registry.GetComponent<ECS::Components::MeshRenderer>(entity);
+        if (!meshRenderer.model || !meshRenderer.shader) continue;
+
+        const auto &transform = registry.GetComponent<ECS::Components::Transform>(entity);
+        auto &lod = registry.GetComponent<LodComponent>(entity);
+        const float radius = lod.boundingRadius * std::max({transform.scale.x, transform.scale.y, transform.scale.z});
+        const float distance = std::max(glm::length(transform.translation - cameraPosition), 0.001f);
+        const float coverage = radius * projectionScale / distance;
+
+        int level = lodEnabled ? lod.currentLevel : 0;
+        if (lodEnabled)
+        {
+            while (level + 1 < lod.levelCount && coverage < LodThresholds[level])
+                level++;
+            while (level > 0 && coverage > LodThresholds[level - 1] * (1.0f + LodHysteresis))
+                level--;
+        }
+        lod.currentLevel = level;
+        Submit(registry, entity, meshRenderer, *lod.levels[level]);
+    }
+}
+
+void MeshSubmitSystem::Submit(ECS::Registry &registry, const ECS::Entity entity, const ECS::Components::MeshRenderer &meshRenderer, Model &model)
+{
+    if (lodLibrary)
+    {
+        lodStats.fullDetailTriangles += lodLibrary->GetTriangleCount(meshRenderer.model);
+        lodStats.submittedTriangles += lodLibrary->GetTriangleCount(&model);
+    }
+
+    if (transformCache && transformCache->Contains(entity))
+    {
+        renderQueue->Submit(RenderPass::Opaque, *meshRenderer.shader, model, transformCache->GetWorldMatrix(entity));
+        return;
+    }
+
+    const auto &transform = registry.GetComponent<ECS::Components::Transform>(entity);
+    const glm::mat4 world = glm::translate(glm::mat4(1.0f), transform.translation)
+                            * glm::mat4_cast(transform.rotation)
+                            * glm::scale(glm::mat4(1.0f), transform.scale);
+    renderQueue->Submit(RenderPass::Opaque, *meshRenderer.shader, model, world);
+}
+
+void MeshSubmitSystem::SetRenderQueue(RenderQueue *queue) { renderQueue = queue; }
+
+void MeshSubmitSystem::SetLodLibrary(const LodLibrary *library) { lodLibrary = library; }
+
+void MeshSubmitSystem::SetSignatures(const GameSignatures *entitySignatures) { signatures = entitySignatures; }
+
+void MeshSubmitSystem::SetTransformCache(const TransformCacheSystem *cache) { transformCache = cache; }
+
+void MeshSubmitSystem::SetCamera(const glm::vec3 &position, const glm::mat4 &projection)
+{
+    cameraPosition = position;
+    // cot(fov / 2), turns radius / distance into a fraction of the half screen height
+    projectionScale = projection[1][1];
+}
+
+void MeshSubmitSystem::SetLodEnabled(const bool enable) { lodEnabled = enable; }
+
+const LodStats &MeshSubmitSystem::GetLodStats() const { return lodStats; }
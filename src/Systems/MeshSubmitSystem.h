@@ -0,0 +1,66 @@
+#ifndef PROYECTOFINAL_CGA_MESHSUBMITSYSTEM_H
+#define PROYECTOFINAL_CGA_MESHSUBMITSYSTEM_H
+
+#include "../Components/GameComponents.h"
+#include "ECS/ISystem.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+
+class RenderQueue;
+class LodLibrary;
+class TransformCacheSystem;
+
+struct LodStats
+{
+    std::size_t submittedTriangles = 0;
+    std::size_t fullDetailTriangles = 0;
+};
+
+/**
+ * Replaces ECS::Systems::RenderSystem, every MeshRenderer is submitted to the frame's render queue instead of drawn.
+ *
+ * Entities with a LodComponent submit the level matching their size on screen.
+ */
+class MeshSubmitSystem final : public ECS::ISystem
+{
+    // Fraction of the half screen height under which the next coarser level is used
+    static constexpr std::array LodThresholds = {0.35f, 0.12f};
+    // A finer level comes back only once the size is this much over its threshold
+    static constexpr float LodHysteresis = 0.15f;
+
+    RenderQueue *renderQueue = nullptr;
+    const LodLibrary *lodLibrary = nullptr;
+    const TransformCacheSystem *transformCache = nullptr;
+    const GameSignatures *signatures = nullptr;
+    glm::vec3 cameraPosition{0.0f};
+    float projectionScale = 1.0f;
+    bool lodEnabled = true;
+    LodStats lodStats{};
+
+    void Submit(ECS::Registry &registry, ECS::Entity entity, const ECS::Components::MeshRenderer &meshRenderer, Model &model);
+
+  public:
+    void Update(ECS::Registry &registry, float deltaTime) override;
+
+    void SetRenderQueue(RenderQueue *queue);
+
+    void SetLodLibrary(const LodLibrary *library);
+
+    /// Splits the meshes with and without LODs, nothing is submitted without them.
+    void SetSignatures(const GameSignatures *entitySignatures);
+
+    /// World matrices are taken from the cache when it has the entity.
+    void SetTransformCache(const TransformCacheSystem *cache);
+
+    /// Camera used to measure the screen size of the entities this frame.
+    void SetCamera(const glm::vec3 &position, const glm::mat4 &projection);
+
+    void SetLodEnabled(bool enable);
+
+    [[nodiscard]] const LodStats &GetLodStats() const;
+};
+
+#endif // PROYECTOFINAL_CGA_MESHSUBMITSYSTEM_H
@@ -0,0 +1,253 @@
+#include "GlobalDefines.h"
+
+#include "ParticleSystem.h"
+
+#include "../Rendering/RenderQueue.h"
+#include "../Services/EntityCommandBuffer.h"
+#include "ECS/Components/Transform.h"
+#include "Shader.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+namespace
+{
+struct EffectInfo
+{
+    ParticleSystem::Material material;
+    glm::vec3 spawnOffset;
+    glm::vec3 spawnExtent;
+    /// Main direction of the particles, zero emits in every direction.
+    glm::vec3 direction;
+    float spread;
+    float minSpeed;
+    float maxSpeed;
+    float minLifetime;
+    float maxLifetime;
+    float gravity;
+    float size;
+    float stretch;
+    glm::vec4 color;
+};
+
+// Indexed by ParticleEffect
+const std::array<EffectInfo, static_cast<std::size_t>(ParticleEffect::Count)> effects = {
+    {
+        // Coin sparkle
+        {ParticleSystem::Material::Additive, {0.0f, 0.0f, 0.0f}, {0.2f, 0.2f, 0.2f}, {0.0f, 1.0f, 0.0f}, 1.2f, 1.5f, 4.0f, 0.35f, 0.7f, -4.0f, 0.12f, 0.0f, {1.0f, 0.85f, 0.25f, 1.0f}},
+        // Obstacle debris
+        {ParticleSystem::Material::AlphaBlend, {0.0f, 0.5f, 0.0f}, {0.4f, 0.4f, 0.4f}, {0.0f, 1.0f, 0.0f}, 0.9f, 3.0f, 6.0f, 0.6f, 1.2f, -9.81f, 0.15f, 0.0f, {0.45f, 0.4f, 0.35f, 1.0f}},
+        // Speed lines, spawned ahead of the runner
+        {ParticleSystem::Material::Additive, {8.0f, 1.0f, 0.0f}, {4.0f, 1.5f, 3.5f}, {-1.0f, 0.0f, 0.0f}, 0.0f, 15.0f, 25.0f, 0.3f, 0.5f, 0.0f, 0.03f, 0.04f, {1.0f, 1.0f, 1.0f, 0.6f}},
+    }
+};
+
+constexpr std::array<float, 8> quadCorners = {-0.5f, -0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f};
+} // namespace
+
+ParticleSystem::ParticleSystem()
+{
+    for (std::size_t i = 0; i < MaterialCount; i++)
+    {
+        pools[i] = ParticlePool(MaxParticlesPerMaterial);
+        draws[i] = {this, static_cast<Material>(i)};
+    }
+}
+
+ParticleSystem::~ParticleSystem()
+{
+    if (texture != 0) glDeleteTextures(1, &texture);
+    if (instanceVbo != 0) glDeleteBuffers(1, &instanceVbo);
+    if (quadVbo != 0) glDeleteBuffers(1, &quadVbo);
+    if (vao != 0) glDeleteVertexArrays(1, &vao);
+}
+
+void ParticleSystem::Init(Shader *particleShader, const std::filesystem::path &texturePath)
+{
+    shader = particleShader;
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &quadVbo);
+    glGenBuffers(1, &instanceVbo);
+    glBindVertexArray(vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadCorners), quadCorners.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+    instanceCapacity = 4096;
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instanceCapacity * sizeof(ParticleInstance)), nullptr, GL_STREAM_DRAW);
+    const std::array offsets = {offsetof(ParticleInstance, positionSize), offsetof(ParticleInstance, color), offsetof(ParticleInstance, velocityStretch)};
+    for (GLuint i = 0; i < offsets.size(); i++)
+    {
+        glEnableVertexAttribArray(i + 1);
+        glVertexAttribPointer(i + 1, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), reinterpret_cast<void *>(offsets[i]));
+        glVertexAttribDivisor(i + 1, 1);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    int width = 0, height = 0, channels = 0;
+    unsigned char *pixels = stbi_load(texturePath.string().c_str(), &width, &height, &channels, 4);
+    std::vector<unsigned char> fallback;
+    if (!pixels)
+    {
+        std::cerr << "\033[33mCannot load the particle texture " << texturePath << ", using a plain dot\033[0m\n";
+        width = height = 32;
+        fallback.resize(static_cast<std::size_t>(width * height * 4));
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+            {
+                const float dx = (static_cast<float>(x) + 0.5f) / 16.0f - 1.0f;
+                const float dy = (static_cast<float>(y) + 0.5f) / 16.0f - 1.0f;
+                const float distance = std::sqrt(dx * dx + dy * dy);
+                const auto alpha = static_cast<unsigned char>(255.0f * std::clamp(1.0f - distance, 0.0f, 1.0f));
+                const auto pixel = static_cast<std::size_t>((y * width + x) * 4);
+                fallback[pixel] = fallback[pixel + 1] = fallback[pixel + 2] = 255;
+                fallback[pixel + 3] = alpha;
+            }
+    }
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels ? pixels : fallback.data());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (pixels) stbi_image_free(pixels);
+}
+
+float ParticleSystem::Random(const float min, const float max)
+{
+    // xorshift32
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return min + (max - min) * static_cast<float>(randomState >> 8) / static_cast<float>(1u << 24);
+}
+
+void ParticleSystem::Emit(const ParticleEffect effect, const glm::vec3 &position, const int amount)
+{
+    const EffectInfo &info = effects[static_cast<std::size_t>(effect)];
+    ParticlePool &pool = pools[static_cast<std::size_t>(info.material)];
+
+    for (int i = 0; i < amount; i++)
+    {
+        glm::vec3 direction{Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f)};
+        direction = info.direction + direction * (glm::length(info.direction) > 0.0f ? info.spread : 1.0f);
+        if (glm::length(direction) < 1e-4f) direction = {0.0f, 1.0f, 0.0f};
+
+        const ParticleSpawn spawn{
+            .position = position + info.spawnOffset + glm::vec3{Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f)} * info.spawnExtent,
+            .velocity = glm::normalize(direction) * Random(info.minSpeed, info.maxSpeed),
+            .color = info.color,
+            .lifetime = Random(info.minLifetime, info.maxLifetime),
+            .size = info.size,
+            .gravity = info.gravity,
+            .stretch = info.stretch,
+        };
+        if (!pool.Emit(spawn)) break;
+    }
+}
+
+void ParticleSystem::Update(ECS::Registry &registry, const float deltaTime)
+{
+    for (const ECS::Entity entity : registry.View<ParticleEmitterComponent, ECS::Components::Transform>())
+    {
+        auto &emitter = registry.GetComponent<ParticleEmitterComponent>(entity);
+        const auto &transform = registry.GetComponent<ECS::Components::Transform>(entity);
+
+        int amount = emitter.burst;
+        emitter.burst = 0;
+        emitter.accumulator += emitter.rate * deltaTime;
+        const float whole = std::floor(emitter.accumulator);
+        emitter.accumulator -= whole;
+        amount += static_cast<int>(whole);
+
+        Emit(emitter.effect, transform.translation + emitter.offset, amount);
+        if (!emitter.oneShot) continue;
+        if (commands)
+            commands->Destroy(entity);
+        else
+            registry.DestroyEntity(entity);
+    }
+
+    for (std::size_t i = 0; i < MaterialCount; i++)
+    {
+        pools[i].Simulate(deltaTime, worldVelocity);
+        if (!renderQueue || pools[i].Size() == 0) continue;
+
+        pools[i].Pack(instances[i], worldVelocity);
+        renderQueue->SubmitCustom(RenderPass::Transparent, DrawMaterial, &draws[i]);
+    }
+}
+
+void ParticleSystem::DrawMaterial(void *userData)
+{
+    const auto &[system, material] = *static_cast<MaterialDraw *>(userData);
+    const auto &particles = system->instances[static_cast<std::size_t>(material)];
+    if (!system->shader || system->vao == 0 || particles.empty()) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, system->instanceVbo);
+    const std::size_t bytes = particles.size() * sizeof(ParticleInstance);
+    if (particles.size() > system->instanceCapacity)
+        system->instanceCapacity = std::max(particles.size(), system->instanceCapacity * 2);
+    // Orphaned every time, the draw of the other material may still be reading the old storage
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(system->instanceCapacity * sizeof(ParticleInstance)), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(bytes), particles.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, material == Material::Additive ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+
+    system->shader->Use();
+    system->shader->Set<4, 4>("viewProjection", system->viewProjection);
+    system->shader->Set<3>("cameraPosition", system->cameraPosition);
+    system->shader->Set("particleTexture", 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, system->texture);
+
+    glBindVertexArray(system->vao);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(particles.size()));
+    glBindVertexArray(0);
+
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+}
+
+void ParticleSystem::SetRenderQueue(RenderQueue *queue) { renderQueue = queue; }
+
+void ParticleSystem::SetCommandBuffer(EntityCommandBuffer *buffer) { commands = buffer; }
+
+void ParticleSystem::SetCamera(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &position)
+{
+    viewProjection = projection * view;
+    cameraPosition = position;
+}
+
+void ParticleSystem::SetWorldVelocity(const glm::vec3 &velocity) { worldVelocity = velocity; }
+
+void ParticleSystem::Clear()
+{
+    for (auto &pool : pools)
+        pool.Clear();
+}
+
+std::size_t ParticleSystem::GetParticleCount() const
+{
+    std::size_t count = 0;
+    for (const auto &pool : pools)
+        count += pool.Size();
+    return count;
+}
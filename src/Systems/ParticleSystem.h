@@ -0,0 +1,102 @@
+#ifndef PROYECTOFINAL_CGA_PARTICLESYSTEM_H
+#define PROYECTOFINAL_CGA_PARTICLESYSTEM_H
+
+#include "../Components/ParticleEmitterComponent.h"
+#include "../Rendering/ParticlePool.h"
+#include "ECS/ISystem.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+class EntityCommandBuffer;
+class RenderQueue;
+class Shader;
+
+/**
+ * Emits and simulates the particles of every ParticleEmitterComponent.
+ *
+ * Each effect belongs to a material (blend mode), all the particles of a
+ * material share one pool and are drawn with a single instanced billboard
+ * call submitted to the transparent pass of the render queue.
+ */
+class ParticleSystem final : public ECS::ISystem
+{
+  public:
+    enum class Material : std::uint8_t
+    {
+        Additive,
+        AlphaBlend,
+        Count
+    };
+
+    static constexpr std::size_t MaxParticlesPerMaterial = 100000;
+
+  private:
+    static constexpr std::size_t MaterialCount = static_cast<std::size_t>(Material::Count);
+
+    struct MaterialDraw
+    {
+        ParticleSystem *system = nullptr;
+        Material material = Material::Additive;
+    };
+
+    std::array<ParticlePool, MaterialCount> pools;
+    std::array<std::vector<ParticleInstance>, MaterialCount> instances;
+    std::array<MaterialDraw, MaterialCount> draws;
+
+    RenderQueue *renderQueue = nullptr;
+    EntityCommandBuffer *commands = nullptr;
+    Shader *shader = nullptr;
+    unsigned int vao = 0;
+    unsigned int quadVbo = 0;
+    unsigned int instanceVbo = 0;
+    std::size_t instanceCapacity = 0;
+    unsigned int texture = 0;
+
+    glm::mat4 viewProjection{1.0f};
+    glm::vec3 cameraPosition{0.0f};
+    glm::vec3 worldVelocity{0.0f};
+    // Own generator, emitting particles must not change the game's random sequence (replays)
+    std::uint32_t randomState = 0x9E3779B9u;
+
+    float Random(float min, float max);
+
+    void Emit(ParticleEffect effect, const glm::vec3 &position, int amount);
+
+    static void DrawMaterial(void *userData);
+
+  public:
+    ParticleSystem();
+
+    ParticleSystem(const ParticleSystem &) = delete;
+
+    ParticleSystem &operator=(const ParticleSystem &) = delete;
+
+    ~ParticleSystem();
+
+    /// Creates the buffers and loads the particle texture, a white dot is used if it cannot be read.
+    void Init(Shader *particleShader, const std::filesystem::path &texturePath);
+
+    void Update(ECS::Registry &registry, float deltaTime) override;
+
+    void SetRenderQueue(RenderQueue *queue);
+
+    /// One shot emitters are destroyed through the buffer when there is one, immediately otherwise.
+    void SetCommandBuffer(EntityCommandBuffer *buffer);
+
+    void SetCamera(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &position);
+
+    /// Velocity added to every particle, the road moves instead of the player.
+    void SetWorldVelocity(const glm::vec3 &velocity);
+
+    void Clear();
+
+    [[nodiscard]] std::size_t GetParticleCount() const;
+};
+
+#endif // PROYECTOFINAL_CGA_PARTICLESYSTEM_H
@@ -1,33 +1,24 @@
 
 #include "RunnerSystem.h"
 
-#include "../Components/FloorComponent.h"
+#include "../Components/GameComponents.h"
 #include "../Components/RunnerComponent.h"
 #include "ECS/Components/Collider.h"
+#include "../Services/ActionQueue.h"
+#include "../Services/GameStats.h"
 #include "ECS/Components/Transform.h"
-#include "Input/Joystick.h"
-#include "Input/Keyboard.h"
-
-#include <GLFW/glfw3.h>
 
 void RunnerSystem::Update(ECS::Registry &registry, float deltaTime)
 {
     if (!enabled) return;
-    const auto kb = Input::Keyboard::GetInstance();
-    const auto joystick = Input::Joystick::GetInstance();
-    const std::vector<ECS::Entity> entities = registry.View<RunnerComponent, ECS::Components::Transform>();
+    const auto actions = ActionQueue::GetInstance();
 
-    if (entities.empty())
+    if (player == NoPlayer)
     {
-        std::cerr << "\033[31mNo player entities found!\033[0m\n";
+        std::cerr << "\033[31mNo player entity set!\033[0m\n";
         return;
     }
 
-    if (entities.size() > 1)
-        std::cout << "\033[33mMore than one player found, taking the first and ignoring others...\033[0m\n";
-
-    const ECS::Entity player = entities[0];
-
     auto &transform = registry.GetComponent<ECS::Components::Transform>(player);
     auto &collider = registry.GetComponent<ECS::Components::AABBCollider>(player);
     auto &runner = registry.GetComponent<RunnerComponent>(player);
@@ -35,36 +26,31 @@ void RunnerSystem::Update(ECS::Registry &registry, float deltaTime)
     runner.grounded = false;
     if (collider.isColliding)
     {
-        const auto playerAABB = collider.GetWorldAABB(transform);
-
+        GameStats::GetInstance()->Add(GameStat::PlayerContacts, collider.collidingEntities.size());
         for (const auto &collidingEntity : collider.collidingEntities)
         {
-            if (!(registry.HasComponent<ECS::Components::AABBCollider>(collidingEntity) && registry.HasComponent<FloorComponent>(collidingEntity)))
+            if (!signatures || !GameQuery<ECS::Components::AABBCollider, FloorComponent>::Matches(*signatures, collidingEntity))
                 continue;
 
-            auto &platformTransform = registry.GetComponent<ECS::Components::Transform>(collidingEntity);
-            auto &platformCollider = registry.GetComponent<ECS::Components::AABBCollider>(collidingEntity);
-            const auto platformAABB = platformCollider.GetWorldAABB(platformTransform);
-
             runner.grounded = true;
-            downTriggered = false;
+            runner.downTriggered = false;
         }
     }
 
     if (runner.grounded)
     {
         runner.velocity.y = 0;
-        if (kb->GetKeyPress(GLFW_KEY_SPACE) || joystick->GetButtonPress(GLFW_GAMEPAD_BUTTON_A))
+        if (actions->WasPressed(Action::Jump) || actions->IsHeld(Action::Jump))
             runner.velocity.y = runner.jumpForce;
     }
     else
     {
         runner.velocity.y += gravity * runner.weight * deltaTime;
 
-        if (!downTriggered && (kb->GetKeyPress(GLFW_KEY_DOWN) || joystick->GetButtonPress(GLFW_GAMEPAD_BUTTON_DPAD_DOWN)))
+        if (!runner.downTriggered && (actions->WasPressed(Action::Dive) || actions->IsHeld(Action::Dive)))
         {
             runner.velocity.y += -5.0f;
-            downTriggered = true;
+            runner.downTriggered = true;
         }
     }
 
@@ -74,24 +60,13 @@ void RunnerSystem::Update(ECS::Registry &registry, float deltaTime)
     if (transform.translation.y < 0.0f)
         transform.translation.y = 1.0f;
 
-    const bool leftDown = kb->GetKeyPress(GLFW_KEY_LEFT) || joystick->GetButtonPress(GLFW_GAMEPAD_BUTTON_DPAD_LEFT);
-    if (leftDown && !leftPressed)
-    {
-        targetLane--;
-    }
-    leftPressed = leftDown;
-
-    const bool rightDown = kb->GetKeyPress(GLFW_KEY_RIGHT) || joystick->GetButtonPress(GLFW_GAMEPAD_BUTTON_DPAD_RIGHT);
-    if (rightDown && !rightPressed)
-    {
-        targetLane++;
-    }
-    rightPressed = rightDown;
+    // Two quick presses in one frame move two lanes
+    runner.targetLane += actions->GetPressCount(Action::MoveRight) - actions->GetPressCount(Action::MoveLeft);
 
-    if (targetLane < -1) targetLane = -1;
-    if (targetLane > 1) targetLane = 1;
+    if (runner.targetLane < -1) runner.targetLane = -1;
+    if (runner.targetLane > 1) runner.targetLane = 1;
 
-    const float targetZ = static_cast<float>(targetLane) * laneWidth;
+    const float targetZ = static_cast<float>(runner.targetLane) * laneWidth;
 
     float newZ = transform.translation.z + (targetZ - transform.translation.z) * horizontalSpeed * deltaTime;
 
@@ -104,3 +79,7 @@ void RunnerSystem::Update(ECS::Registry &registry, float deltaTime)
 void RunnerSystem::SetEnabled(const bool enable) { this->enabled = enable; }
 
 bool RunnerSystem::IsEnabled() const { return enabled; }
+
+void RunnerSystem::SetPlayer(const ECS::Entity entity) { player = entity; }
+
+void RunnerSystem::SetSignatures(const GameSignatures *entitySignatures) { signatures = entitySignatures; }
@@ -5,25 +5,24 @@
 #ifndef PROYECTOFINAL_CGA_RUNNERSYSTEM_H
 #define PROYECTOFINAL_CGA_RUNNERSYSTEM_H
 
+#include "../Components/GameComponents.h"
 #include "ECS/ISystem.h"
 
-namespace Input
-{
-class Keyboard;
-class Joystick;
-} // namespace Input
+#include <limits>
 
 constexpr float gravity = -9.81f;
 
 class RunnerSystem final : public ECS::ISystem
 {
+  public:
+    static constexpr ECS::Entity NoPlayer = std::numeric_limits<ECS::Entity>::max();
+
+  private:
+    ECS::Entity player = NoPlayer;
+    const GameSignatures *signatures = nullptr;
     bool enabled = false;
-    bool downTriggered = false;
-    int targetLane = 0;
     float laneWidth = 2.0f;
     float horizontalSpeed = 10.0f;
-    bool leftPressed = false;
-    bool rightPressed = false;
 
   public:
     void Update(ECS::Registry &registry, float deltaTime) override;
@@ -31,6 +30,12 @@ class RunnerSystem final : public ECS::ISystem
     void SetEnabled(bool enable);
 
     bool IsEnabled() const;
+
+    /// The player is handed over by whoever creates it instead of searched every frame, NoPlayer outside a run.
+    void SetPlayer(ECS::Entity entity);
+
+    /// Tells the floor apart in the player's contacts, the runner never lands without them.
+    void SetSignatures(const GameSignatures *entitySignatures);
 };
 
 #endif // PROYECTOFINAL_CGA_RUNNERSYSTEM_H
@@ -0,0 +1,167 @@
+#include "TransformCacheSystem.h"
+
+#include "../Components/ParentComponent.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+bool SameTransform(const ECS::Components::Transform &a, const ECS::Components::Transform &b)
+{
+    return a.translation == b.translation && a.rotation == b.rotation && a.scale == b.scale;
+}
+
+/// Scalar version of the kernel's box, for the few matrices built outside the batch.
+ECS::Components::AABB EnclosingAABB(const glm::mat4 &world, const glm::vec3 &min, const glm::vec3 &max)
+{
+    const glm::vec3 center = (min + max) * 0.5f;
+    const glm::vec3 extent = (max - min) * 0.5f;
+    glm::vec3 worldCenter(world[3]);
+    glm::vec3 worldExtent(0.0f);
+    for (int column = 0; column < 3; column++)
+        for (int row = 0; row < 3; row++)
+        {
+            worldCenter[row] += world[column][row] * center[column];
+            worldExtent[row] += std::abs(world[column][row]) * extent[column];
+        }
+    return {.min = worldCenter - worldExtent, .max = worldCenter + worldExtent};
+}
+} // namespace
+
+void TransformCacheSystem::Update(ECS::Registry &registry, [[maybe_unused]] float deltaTime)
+{
+    const auto start = std::chrono::steady_clock::now();
+    frame++;
+    dirty.clear();
+    children.clear();
+    std::size_t updated = 0;
+
+    const std::vector<ECS::Entity> entities = registry.View<ECS::Components::Transform>();
+    for (const ECS::Entity entity : entities)
+    {
+        if (entity >= entries.size())
+        {
+            entries.resize(entity + 1);
+            localMatrices.resize(entity + 1, glm::mat4(1.0f));
+            worldMatrices.resize(entity + 1, glm::mat4(1.0f));
+            worldAABBs.resize(entity + 1);
+        }
+
+        CacheEntry &entry = entries[entity];
+        const auto &transform = registry.GetComponent<ECS::Components::Transform>(entity);
+        glm::vec3 colliderMin(0.0f), colliderMax(0.0f);
+        if (registry.HasComponent<ECS::Components::AABBCollider>(entity))
+        {
+            const auto &collider = registry.GetComponent<ECS::Components::AABBCollider>(entity);
+            colliderMin = collider.min;
+            colliderMax = collider.max;
+        }
+        const ECS::Entity parent = registry.HasComponent<ParentComponent>(entity) ? registry.GetComponent<ParentComponent>(entity).parent : NoParent;
+
+        entry.lastSeen = frame;
+        if (parent != NoParent) children.push_back(entity);
+
+        const bool changed = entry.version == 0 || !SameTransform(entry.transform, transform) || entry.colliderMin != colliderMin
+                             || entry.colliderMax != colliderMax || entry.parent != parent;
+        if (!changed) continue;
+
+        entry.transform = transform;
+        entry.colliderMin = colliderMin;
+        entry.colliderMax = colliderMax;
+        entry.parent = parent;
+        entry.localChangedFrame = frame;
+        dirty.push_back(entity);
+    }
+
+    if (!dirty.empty())
+    {
+        using S = TransformBatch;
+        batch.Resize(dirty.size());
+        for (std::size_t i = 0; i < dirty.size(); i++)
+        {
+            const CacheEntry &entry = entries[dirty[i]];
+            for (int axis = 0; axis < 3; axis++)
+            {
+                batch[static_cast<S::Stream>(S::TranslationX + axis)][i] = entry.transform.translation[axis];
+                batch[static_cast<S::Stream>(S::ScaleX + axis)][i] = entry.transform.scale[axis];
+                batch[static_cast<S::Stream>(S::LocalMinX + axis)][i] = entry.colliderMin[axis];
+                batch[static_cast<S::Stream>(S::LocalMaxX + axis)][i] = entry.colliderMax[axis];
+            }
+            batch[S::RotationX][i] = entry.transform.rotation.x;
+            batch[S::RotationY][i] = entry.transform.rotation.y;
+            batch[S::RotationZ][i] = entry.transform.rotation.z;
+            batch[S::RotationW][i] = entry.transform.rotation.w;
+        }
+
+        ComputeWorldTransforms(batch);
+
+        for (std::size_t i = 0; i < dirty.size(); i++)
+        {
+            const ECS::Entity entity = dirty[i];
+            glm::mat4 &local = localMatrices[entity];
+            for (int column = 0; column < 3; column++)
+            {
+                for (int row = 0; row < 3; row++)
+                    local[column][row] = batch[static_cast<S::Stream>(S::Basis00 + column * 3 + row)][i];
+                local[column][3] = 0.0f;
+            }
+            local[3] = glm::vec4(entries[entity].transform.translation, 1.0f);
+
+            // Children are resolved below, once their parents are
+            CacheEntry &entry = entries[entity];
+            if (entry.parent != NoParent) continue;
+            worldMatrices[entity] = local;
+            worldAABBs[entity] = {
+                .min = {batch[S::WorldMinX][i], batch[S::WorldMinY][i], batch[S::WorldMinZ][i]},
+                .max = {batch[S::WorldMaxX][i], batch[S::WorldMaxY][i], batch[S::WorldMaxZ][i]},
+            };
+            entry.version++;
+            updated++;
+        }
+    }
+
+    if (!children.empty())
+    {
+        // Parents first, the depth is capped so a cycle cannot hang the loop
+        constexpr int maxDepth = 16;
+        for (const ECS::Entity child : children)
+        {
+            int depth = 0;
+            for (ECS::Entity parent = entries[child].parent; parent != NoParent && parent < entries.size() && depth < maxDepth; parent = entries[parent].parent)
+                depth++;
+            entries[child].depth = depth;
+        }
+        std::ranges::stable_sort(children, {}, [this](const ECS::Entity child) -> int { return entries[child].depth; });
+
+        for (const ECS::Entity child : children)
+        {
+            CacheEntry &entry = entries[child];
+            const bool parentAlive = Contains(entry.parent);
+            const std::uint32_t parentVersion = parentAlive ? entries[entry.parent].version : 0;
+            if (entry.localChangedFrame != frame && entry.parentVersion == parentVersion) continue;
+
+            // A child whose parent is gone stays where its local transform puts it
+            worldMatrices[child] = parentAlive ? worldMatrices[entry.parent] * localMatrices[child] : localMatrices[child];
+            worldAABBs[child] = EnclosingAABB(worldMatrices[child], entry.colliderMin, entry.colliderMax);
+            entry.parentVersion = parentVersion;
+            entry.version++;
+            updated++;
+        }
+    }
+
+    stats = {
+        .entities = entities.size(),
+        .updated = updated,
+        .milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count(),
+    };
+}
+
+bool TransformCacheSystem::Contains(const ECS::Entity entity) const { return entity < entries.size() && entries[entity].lastSeen == frame; }
+
+const glm::mat4 &TransformCacheSystem::GetWorldMatrix(const ECS::Entity entity) const { return worldMatrices[entity]; }
+
+const ECS::Components::AABB &TransformCacheSystem::GetWorldAABB(const ECS::Entity entity) const { return worldAABBs[entity]; }
+
+const TransformCacheStats &TransformCacheSystem::GetStats() const { return stats; }
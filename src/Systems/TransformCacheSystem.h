@@ -0,0 +1,82 @@
+#ifndef PROYECTOFINAL_CGA_TRANSFORMCACHESYSTEM_H
+#define PROYECTOFINAL_CGA_TRANSFORMCACHESYSTEM_H
+
+#include "../Rendering/TransformKernel.h"
+#include "ECS/Components/Collider.h"
+#include "ECS/Components/Transform.h"
+#include "ECS/ISystem.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+struct TransformCacheStats
+{
+    std::size_t entities = 0;
+    std::size_t updated = 0;
+    float milliseconds = 0.0f;
+};
+
+/**
+ * World matrices and world AABBs of every entity with a Transform, cached
+ * until the transform (or the collider box) changes.
+ *
+ * The engine's Transform has no dirty flag, so each update compares the
+ * components with the cached copy and recomputes only the changed entities,
+ * all of them in one batch with the SIMD kernel. A reused entity id is only
+ * recomputed if its components differ, the cached values would be the same
+ * anyway.
+ *
+ * Entities with a ParentComponent are relative to their parent, their world
+ * matrix is recomputed when either their own transform or their parent's
+ * world matrix changes. Every change of the world matrix increments the
+ * entity's version, which is how its children notice.
+ */
+class TransformCacheSystem final : public ECS::ISystem
+{
+    static constexpr ECS::Entity NoParent = std::numeric_limits<ECS::Entity>::max();
+
+    struct CacheEntry
+    {
+        ECS::Components::Transform transform{};
+        glm::vec3 colliderMin{0.0f};
+        glm::vec3 colliderMax{0.0f};
+        ECS::Entity parent = NoParent;
+        // Version of the parent the world matrix was built from
+        std::uint32_t parentVersion = 0;
+        int depth = 0;
+        std::uint32_t version = 0;
+        // Updates in which the entity was last seen (destroyed entities keep an old one) and last changed
+        std::uint32_t lastSeen = 0;
+        std::uint32_t localChangedFrame = 0;
+    };
+
+    std::vector<CacheEntry> entries;
+    std::vector<glm::mat4> localMatrices;
+    std::vector<glm::mat4> worldMatrices;
+    std::vector<ECS::Components::AABB> worldAABBs;
+    std::vector<ECS::Entity> dirty;
+    std::vector<ECS::Entity> children;
+    TransformBatch batch;
+    TransformCacheStats stats{};
+    std::uint32_t frame = 0;
+
+  public:
+    void Update(ECS::Registry &registry, float deltaTime) override;
+
+    /// True if the entity had a Transform in the last update.
+    [[nodiscard]] bool Contains(ECS::Entity entity) const;
+
+    /// translate * rotate * scale of the entity's transform, after the parent's world matrix.
+    [[nodiscard]] const glm::mat4 &GetWorldMatrix(ECS::Entity entity) const;
+
+    /// Box enclosing the collider's box after the transform, the transform's origin for entities without one.
+    [[nodiscard]] const ECS::Components::AABB &GetWorldAABB(ECS::Entity entity) const;
+
+    [[nodiscard]] const TransformCacheStats &GetStats() const;
+};
+
+#endif // PROYECTOFINAL_CGA_TRANSFORMCACHESYSTEM_H
@@ -10,12 +10,15 @@
 #include "Components/BuildingComponent.h"
 #include "Components/CoinComponent.h"
 #include "Components/FloorComponent.h"
+#include "Components/GameComponents.h"
+#include "Components/LodComponent.h"
 #include "Components/ObstacleComponent.h"
+#include "Components/ParentComponent.h"
+#include "Components/ParticleEmitterComponent.h"
 #include "Components/PathComponent.h"
 #include "Components/RunnerComponent.h"
 #include "DebugSettings.h"
 #include "DepthCubemap.h"
-#include "DepthMap.h"
 #include "ECS/Components/AudioListener.h"
 #include "ECS/Components/AudioSource.h"
 #include "ECS/Components/Collider.h"
@@ -25,7 +28,6 @@
 #include "ECS/SystemManager.h"
 #include "ECS/Systems/AudioSystem.h"
 #include "ECS/Systems/CollisionSystem.h"
-#include "ECS/Systems/RenderSystem.h"
 #include "FontType.h"
 #include "Input/Joystick.h"
 #include "Input/Keyboard.h"
@@ -33,27 +35,61 @@
 #include "Lights/DirectionalLight.h"
 #include "Lights/PointLight.h"
 #include "Model.h"
-#include "Primitives/Cube.h"
 #include "Primitives/Plane.h"
+#include "Rendering/CascadedShadowMap.h"
+#include "Rendering/ClusteredLights.h"
+#include "Rendering/DebugDraw.h"
+#include "Rendering/DynamicResolution.h"
+#include "Rendering/DynamicStorageBuffer.h"
+#include "Rendering/FrameCapture.h"
+#include "Rendering/GpuTimer.h"
+#include "Rendering/LodLibrary.h"
+#include "Rendering/MeshOptimizer.h"
+#include "Rendering/ParticlePool.h"
+#include "Rendering/RenderQueue.h"
+#include "Rendering/ShaderVariantCache.h"
+#include "Rendering/ShadowCache.h"
+#include "Rendering/TransformKernel.h"
 #include "Resources/ResourceManager.h"
+#include "Services/ActionQueue.h"
+#include "Services/AllocationCounter.h"
+#include "Services/BenchmarkSweep.h"
+#include "Services/EntityCommandBuffer.h"
+#include "Services/FileWatcher.h"
+#include "Services/FrameArena.h"
+#include "Services/FrameProfiler.h"
+#include "Services/GameStats.h"
+#include "Services/MemoryTracker.h"
+#include "Services/RegistrySnapshot.h"
+#include "Services/Replay.h"
 #include "Shader.h"
 #include "SkinnedAnimation.h"
 #include "SkinnedAnimator.h"
 #include "Skybox.h"
-#include "StorageBufferDynamicArray.h"
 #include "Systems/CoinSystem.h"
+#include "Systems/MeshSubmitSystem.h"
+#include "Systems/ParticleSystem.h"
 #include "Systems/RunnerSystem.h"
+#include "Systems/TransformCacheSystem.h"
 #include "Window.h"
 #include "imgui.h"
 
 #include <AL/alut.h>
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <deque>
+#include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <optional>
 #include <random>
+#include <stdexcept>
+#include <unordered_map>
 #include <vector>
 
 #define RGBCOLOR(r, g, b) glm::vec3(r / 255.0f, g / 255.0f, b / 255.0f)
@@ -62,7 +98,8 @@ enum GameScene
 {
     MAINMENU,
     INGAME,
-    GAMEOVER
+    GAMEOVER,
+    BENCHMARK
 };
 
 enum MenuOptions
@@ -71,32 +108,23 @@ enum MenuOptions
     EXIT
 };
 
-struct SingleKeyPress
-{
-    bool clicked = true;
-    bool event = true;
-};
-
-SingleKeyPress debugMode;
-SingleKeyPress menuUp;
-SingleKeyPress menuDown;
-SingleKeyPress cameraChange;
 GameScene gameScene = MAINMENU;
 uint32_t currentOption = 0;
 std::array menuOptions = {START, EXIT};
 
 const std::string debugSettingsPath = "./debug_settings.json";
+const std::string shaderCachePath = "./shader_cache/";
 
 float deltaTime, lastTime;
 float red = 0.0f;
 bool showDebugGui = false;
-bool enableCursorEvent = true;
-bool fullscreenEvent;
 bool enableCursor = true;
 bool enableGrid = false;
 bool enableSkybox = true;
 bool enablePixelate = true;
 bool polygonMode = false;
+bool enableShadowCache = true;
+bool enableShaderVariants = true;
 int pixelFbResolution = 520;
 int lastPixelFbResolution = 520;
 bool mainGameStarted = false;
@@ -156,18 +184,55 @@ Model lowPolyManModel(
 SkinnedAnimation *playerAnimation;
 SkinnedAnimator playerAnimator;
 
+// Same files the models above are loaded from, used by the mesh report, the LODs and hot reload
+const std::string assetsRoot =
+#if defined(DEBUG) || defined(USE_DEBUG_ASSETS)
+    "."
+#endif
+    "./assets/";
+const std::string modelsRoot = assetsRoot + "models/";
+const std::string shadersRoot =
+#if defined(DEBUG) || defined(USE_DEBUG_ASSETS)
+    "."
+#endif
+    "./shaders/";
+const std::array<std::pair<Model *, const char *>, 9> gameModels = {
+    {{&oxxoStore, "OxxoStore/OxxoStore.obj"},
+     {&pathChunk01, "Path/Path.obj"},
+     {&tsuruCar, "Tsuru/Tsuru.obj"},
+     {&iceCreamCart, "IceCreamCart/IceCreamCart.fbx"},
+     {&microbus, "Microbus/Microbus.obj"},
+     {&storeModel, "Store/Store.obj"},
+     {&coinModel, "Coin/Coin.obj"},
+     {&buildingModel, "LowPolyBuilding/otherbuilding.obj"},
+     {&lowPolyManModel, "LowPolyMan/LowPolyMan.fbx"}}
+};
+LodLibrary lodLibrary;
+bool enableLod = true;
+std::future<std::vector<MeshOptimizer::MeshReport>> meshReportTask;
+std::vector<MeshOptimizer::MeshReport> meshReports;
+
 // endregion Models Section
 
-Input::Keyboard &keyboard = *Input::Keyboard::GetInstance();
 Input::Mouse &mouse = *Input::Mouse::GetInstance();
 Input::Joystick &joystick = *Input::Joystick::GetInstance();
+ActionQueue &actions = *ActionQueue::GetInstance();
 Resources::ResourceManager &resources = *Resources::ResourceManager::GetInstance();
 
-GLuint particleVAO;
+struct SceneObject
+{
+    Model *model = nullptr;
+    glm::mat4 transform{1.0f};
+};
 
-struct Uniforms
+/// Frame data needed by the custom draws submitted to the render queue.
+struct FrameDrawContext
 {
-    GLint model = 0;
+    Skybox *skybox = nullptr;
+    FontType *font = nullptr;
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::vec3 cameraPosition{0.0f};
 };
 
 struct ObstacleInfo
@@ -175,6 +240,7 @@ struct ObstacleInfo
     ECS::Components::Transform transform{};
     ECS::Components::AABBCollider collider{};
     ECS::Components::MeshRenderer meshRenderer{};
+    LodComponent lod{};
 };
 
 struct BuildingInfo
@@ -182,6 +248,7 @@ struct BuildingInfo
     ECS::Components::Transform transform{};
     ECS::Components::MeshRenderer meshRenderer{};
     BuildingComponent buildingComponent{};
+    LodComponent lod{};
 };
 
 std::unordered_map<std::string, ObstacleInfo, string_hash> obstacleGenComponents;
@@ -203,19 +270,25 @@ constexpr std::array ObstaclePatterns = {
     std::array{OBSTACLE, CLEAN,    OBSTACLE},
 };
 
-std::random_device randomDevice;
-std::mt19937 generator(randomDevice());
+// Seeded in main, a replay needs the seed of its recording
+std::mt19937 generator;
 std::uniform_int_distribution<int> obstaclePatternGenerator(0, ObstaclePatterns.size() - 1);
 
-Uniforms uniforms{};
+std::vector<SceneObject> menuScene;
 
 Primitives::Plane plane;
-Primitives::Cube cube;
+DebugDraw debugDraw;
 
 ECS::Registry registry;
+// Spawns and destroys of the systems and the game logic, applied at the sync points of the frame
+EntityCommandBuffer entityCommands;
+// Component mask of every entity for the queries, the playbacks of entityCommands keep it current
+GameSignatures entitySignatures;
 ECS::SystemManager systemManager;
 
 ECS::Entity player;
+// Child of the player with the offset of the skinned mesh
+ECS::Entity playerMesh;
 ECS::Entity floorEntity;
 ECS::Entity cameraEntity;
 
@@ -231,6 +304,7 @@ Shader skyboxShader;
 Shader gridShader;
 Shader fbPixelShader;
 Shader debugShader;
+Shader particleShader;
 Shader depthShader;
 Shader pointDepthShader;
 
@@ -240,6 +314,14 @@ int pathsGenerated = 0;
 bool obstaclesCanSpawn = false;
 constexpr int generatorSpaceInterval = 6;
 constexpr int maxLives = 3;
+constexpr float cameraFov = 45.0f;
+constexpr float cameraNearPlane = 0.1f;
+constexpr float cameraFarPlane = 100.0f;
+// 3 cascades of 1024² use fewer texels than the old single 2048² map
+constexpr int shadowCascades = 3;
+constexpr int shadowCascadeResolution = 1024;
+constexpr float shadowDistance = 60.0f;
+constexpr int pointShadowMapResolution = 1024;
 
 // Building generation
 float lastBuildingXLeft = 20.0f;
@@ -247,35 +329,211 @@ float lastBuildingXRight = 20.0f;
 constexpr float buildingSeparation = 30.0f; // min distance between buildings
 constexpr float buildingSideOffset = 8.0f;
 
+// Live heap megabytes per subsystem, checked only in builds with ENABLE_MEMORY_TRACKING
+constexpr std::array<std::pair<MemoryTag, std::size_t>, 6> memoryBudgets = {
+    std::pair{MemoryTag::Registry,  16 },
+    std::pair{MemoryTag::Models,    512},
+    std::pair{MemoryTag::Textures,  256},
+    std::pair{MemoryTag::Particles, 16 },
+    std::pair{MemoryTag::Rendering, 32 },
+    std::pair{MemoryTag::Gui,       16 },
+};
+
 // endregion Game Variables
 
-void ConfigureKeys(Window &window)
+// region Snapshots
+using GameRegistrySnapshot = GameComponents::Apply<RegistrySnapshot>;
+
+/// Registry plus the game variables, everything needed to put a run back where it was.
+struct GameSnapshot
+{
+    GameRegistrySnapshot entities;
+    float metersRunned = 0.0f;
+    int pathsGenerated = 0;
+    bool obstaclesCanSpawn = false;
+    float lastBuildingXLeft = 0.0f;
+    float lastBuildingXRight = 0.0f;
+    ECS::Entity player = 0;
+    ECS::Entity playerMesh = 0;
+    ECS::Entity floorEntity = 0;
+    ECS::Entity cameraEntity = 0;
+    ECS::Entity lastPath = 0;
+    GameStats::Counters stats{};
+    std::mt19937 generator;
+};
+
+void CaptureGame(GameSnapshot &snapshot)
+{
+    snapshot.entities.Capture(registry);
+    snapshot.metersRunned = metersRunned;
+    snapshot.pathsGenerated = pathsGenerated;
+    snapshot.obstaclesCanSpawn = obstaclesCanSpawn;
+    snapshot.lastBuildingXLeft = lastBuildingXLeft;
+    snapshot.lastBuildingXRight = lastBuildingXRight;
+    snapshot.player = player;
+    snapshot.playerMesh = playerMesh;
+    snapshot.floorEntity = floorEntity;
+    snapshot.cameraEntity = cameraEntity;
+    snapshot.lastPath = lastPath;
+    snapshot.stats = GameStats::GetInstance()->GetCounters();
+    snapshot.generator = generator;
+}
+
+/// Without the generator the run goes on with new obstacle patterns, a replay needs it restored.
+void RestoreGame(const GameSnapshot &snapshot, const bool restoreGenerator)
+{
+    entityCommands.Clear();
+    const EntityRemap remap = snapshot.entities.Restore(registry);
+    entitySignatures.Rebuild(registry);
+    metersRunned = snapshot.metersRunned;
+    pathsGenerated = snapshot.pathsGenerated;
+    obstaclesCanSpawn = snapshot.obstaclesCanSpawn;
+    lastBuildingXLeft = snapshot.lastBuildingXLeft;
+    lastBuildingXRight = snapshot.lastBuildingXRight;
+    player = remap(snapshot.player);
+    playerMesh = remap(snapshot.playerMesh);
+    floorEntity = remap(snapshot.floorEntity);
+    cameraEntity = remap(snapshot.cameraEntity);
+    lastPath = remap(snapshot.lastPath);
+    GameStats::GetInstance()->SetCounters(snapshot.stats);
+    if (restoreGenerator) generator = snapshot.generator;
+}
+
+/// The last seconds of the run, "continue" goes back to the oldest snapshot.
+struct RewindBuffer
+{
+    static constexpr float Interval = 0.5f;
+
+    std::array<GameSnapshot, 6> snapshots;
+    std::size_t next = 0;
+    std::size_t count = 0;
+    float timer = 0.0f;
+
+    void Clear()
+    {
+        next = 0;
+        count = 0;
+        timer = 0.0f;
+    }
+
+    void Update(const float deltaTime)
+    {
+        timer += deltaTime;
+        if (timer < Interval) return;
+        timer = 0.0f;
+        CaptureGame(snapshots[next]);
+        next = (next + 1) % snapshots.size();
+        count = std::min(count + 1, snapshots.size());
+    }
+
+    [[nodiscard]] const GameSnapshot *Oldest() const { return count == 0 ? nullptr : &snapshots[(next + snapshots.size() - count) % snapshots.size()]; }
+};
+
+// Empty registry with the default game variables, and the game right after LoadInGameEntities
+GameSnapshot initialGame;
+GameSnapshot runStart;
+RewindBuffer rewindBuffer;
+// endregion Snapshots
+
+/// "name[index]" in a stack buffer, for the uniform arrays set every frame.
+class IndexedUniformName
+{
+    std::array<char, 48> text{};
+
+  public:
+    IndexedUniformName(const std::string_view name, const int index)
+    {
+        const auto result = std::format_to_n(text.data(), static_cast<std::ptrdiff_t>(text.size() - 1), "{}[{}]", name, index);
+        *result.out = '\0';
+    }
+
+    [[nodiscard]] const char *c_str() const { return text.data(); }
+};
+
+/// Locations of the uniforms the frame sets on a base program, arrays by their element 0 (the others follow).
+struct BaseUniforms
+{
+    unsigned int program = 0;
+    GLint shadowPcfRadius = -1;
+    GLint calculatePointLightShadows = -1;
+    GLint clusterNear = -1;
+    GLint clusterFar = -1;
+    GLint directionalLightsSize = -1;
+    GLint view = -1;
+    GLint projection = -1;
+    GLint ambientLightColor = -1;
+    GLint fogColor = -1;
+    GLint lightSpaceMatrices = -1;
+    GLint cascadeFarPlanes = -1;
+    GLint cascadeTexelDepths = -1;
+    GLint cascadeCount = -1;
+    GLint farPlane = -1;
+    GLint shadowMap = -1;
+    GLint depthMap = -1;
+};
+
+/// Looked up once per program, the variants fold shadowPcfRadius and calculatePointLightShadows into constants and have neither.
+BaseUniforms LocateBaseUniforms(const unsigned int program)
+{
+    if (program == 0) return {};
+    return {
+        .program = program,
+        .shadowPcfRadius = glGetUniformLocation(program, "shadowPcfRadius"),
+        .calculatePointLightShadows = glGetUniformLocation(program, "calculatePointLightShadows"),
+        .clusterNear = glGetUniformLocation(program, "clusterNear"),
+        .clusterFar = glGetUniformLocation(program, "clusterFar"),
+        .directionalLightsSize = glGetUniformLocation(program, "directionalLightsSize"),
+        .view = glGetUniformLocation(program, "view"),
+        .projection = glGetUniformLocation(program, "projection"),
+        .ambientLightColor = glGetUniformLocation(program, "ambientLightColor"),
+        .fogColor = glGetUniformLocation(program, "fogColor"),
+        .lightSpaceMatrices = glGetUniformLocation(program, "lightSpaceMatrices[0]"),
+        .cascadeFarPlanes = glGetUniformLocation(program, "cascadeFarPlanes[0]"),
+        .cascadeTexelDepths = glGetUniformLocation(program, "cascadeTexelDepths[0]"),
+        .cascadeCount = glGetUniformLocation(program, "cascadeCount"),
+        .farPlane = glGetUniformLocation(program, "far_plane"),
+        .shadowMap = glGetUniformLocation(program, "shadowMap"),
+        .depthMap = glGetUniformLocation(program, "depthMap"),
+    };
+}
+
+/// Formats into a string that keeps its capacity from the previous frames.
+template <typename... Args>
+const std::string &FormatInto(std::string &out, std::format_string<Args...> format, Args &&...args)
+{
+    out.clear();
+    std::format_to(std::back_inserter(out), format, std::forward<Args>(args)...);
+    return out;
+}
+
+void ConfigureKeys()
 {
-    keyboard
-        .AddCallback(GLFW_KEY_ESCAPE, [&window]() -> void
-                     {
-                         window.SetShouldClose(true);
-                     })
-        .AddCallback(GLFW_KEY_T, [&window]() -> void
-                     {
-                         if (enableCursorEvent) return;
-                         enableCursorEvent = true;
-                         enableCursor = !enableCursor;
-                         mouse.ToggleMouse(enableCursor);
-                         window.SetMouseStatus(enableCursor);
-                     })
-        .AddCallback(GLFW_KEY_F11, [&window]() -> void
-                     {
-                         if (fullscreenEvent) return;
-                         fullscreenEvent = true;
-                         window.ToggleFullscreen();
-                     })
-        .AddCallback(GLFW_KEY_F3, []() -> void
-                     {
-                         if (debugMode.event) return;
-                         debugMode.event = true;
-                         showDebugGui = !showDebugGui;
-                     });
+    actions.Install(glfwGetCurrentContext());
+    actions
+        .BindKey(Action::MenuUp, GLFW_KEY_UP)
+        .BindGamepadButton(Action::MenuUp, GLFW_GAMEPAD_BUTTON_DPAD_UP)
+        .BindKey(Action::MenuDown, GLFW_KEY_DOWN)
+        .BindGamepadButton(Action::MenuDown, GLFW_GAMEPAD_BUTTON_DPAD_DOWN)
+        .BindKey(Action::Confirm, GLFW_KEY_ENTER)
+        .BindGamepadButton(Action::Confirm, GLFW_GAMEPAD_BUTTON_A)
+        .BindKey(Action::Restart, GLFW_KEY_C)
+        .BindGamepadButton(Action::Restart, GLFW_GAMEPAD_BUTTON_A)
+        .BindKey(Action::Continue, GLFW_KEY_R)
+        .BindGamepadButton(Action::Continue, GLFW_GAMEPAD_BUTTON_Y)
+        .BindKey(Action::MoveLeft, GLFW_KEY_LEFT)
+        .BindGamepadButton(Action::MoveLeft, GLFW_GAMEPAD_BUTTON_DPAD_LEFT)
+        .BindKey(Action::MoveRight, GLFW_KEY_RIGHT)
+        .BindGamepadButton(Action::MoveRight, GLFW_GAMEPAD_BUTTON_DPAD_RIGHT)
+        .BindKey(Action::Jump, GLFW_KEY_SPACE)
+        .BindGamepadButton(Action::Jump, GLFW_GAMEPAD_BUTTON_A)
+        .BindKey(Action::Dive, GLFW_KEY_DOWN)
+        .BindGamepadButton(Action::Dive, GLFW_GAMEPAD_BUTTON_DPAD_DOWN)
+        .BindKey(Action::Quit, GLFW_KEY_ESCAPE)
+        .BindKey(Action::ToggleCursor, GLFW_KEY_T)
+        .BindKey(Action::ToggleFullscreen, GLFW_KEY_F11)
+        .BindKey(Action::ToggleDebugGui, GLFW_KEY_F3)
+        .BindKey(Action::ToggleFreeCamera, GLFW_KEY_P)
+        .BindKey(Action::Screenshot, GLFW_KEY_F12);
 }
 
 void LoadSettings()
@@ -293,6 +551,252 @@ void SaveSettings()
     }
 }
 
+enum class OffscreenApi : std::uint8_t
+{
+    None,
+    Egl,
+    OSMesa
+};
+
+struct LaunchOptions
+{
+    std::string recordPath;
+    std::string replayPath;
+    std::string benchmarkPath;
+    std::string capturePath;
+    bool headless = false;
+    OffscreenApi offscreen = OffscreenApi::None;
+    bool particleBenchmark = false;
+    bool transformBenchmark = false;
+    std::optional<std::uint32_t> seed;
+};
+
+LaunchOptions ParseArguments(const int argc, char *argv[])
+{
+    LaunchOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--record" && hasValue)
+            options.recordPath = argv[++i];
+        else if (argument == "--replay" && hasValue)
+            options.replayPath = argv[++i];
+        else if (argument == "--benchmark" && hasValue)
+            options.benchmarkPath = argv[++i];
+        else if (argument == "--capture" && hasValue)
+            options.capturePath = argv[++i];
+        else if (argument == "--seed" && hasValue)
+        {
+            try
+            {
+                options.seed = static_cast<std::uint32_t>(std::stoul(argv[++i]));
+            }
+            catch (const std::logic_error &)
+            {
+                std::cerr << "\033[31mInvalid seed " << argv[i] << ", the run uses a random one\033[0m\n";
+            }
+        }
+        else if (argument == "--headless")
+            options.headless = true;
+        else if (argument == "--offscreen")
+            options.offscreen = OffscreenApi::Egl;
+        else if (argument == "--offscreen-osmesa")
+            options.offscreen = OffscreenApi::OSMesa;
+        else if (argument == "--particle-benchmark")
+            options.particleBenchmark = true;
+        else if (argument == "--transform-benchmark")
+            options.transformBenchmark = true;
+        else
+            std::cerr << "\033[33mUnknown argument " << argument << ", usage: [--record file] [--replay file | --benchmark file] [--capture file] [--headless] [--offscreen | --offscreen-osmesa] [--seed n] [--particle-benchmark] [--transform-benchmark]\033[0m\n";
+    }
+    return options;
+}
+
+/**
+ * Makes the next window an offscreen one: GLFW's null platform needs no display
+ * and creates the context with EGL (surfaceless Mesa, a pbuffer backs the default
+ * framebuffer) or OSMesa. On machines without a GPU Mesa renders with llvmpipe.
+ * Must be called before the Window is created, the window hints stay set.
+ */
+bool ConfigureOffscreenContext([[maybe_unused]] const OffscreenApi api)
+{
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+    glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    if (!glfwInit())
+    {
+        std::cerr << "\033[31mCannot initialize GLFW's null platform for offscreen rendering\033[0m\n";
+        return false;
+    }
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, api == OffscreenApi::OSMesa ? GLFW_OSMESA_CONTEXT_API : GLFW_EGL_CONTEXT_API);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    return true;
+#else
+    std::cerr << "\033[31mOffscreen rendering needs GLFW 3.4 or newer\033[0m\n";
+    return false;
+#endif
+}
+
+/**
+ * Simulates and packs a full pool of particles for a few hundred frames, no window needed.
+ * Returns the process exit code, 1 if the average frame goes over the CPU budget.
+ */
+int RunParticleBenchmark()
+{
+    constexpr std::size_t particleCount = 100000;
+    constexpr int frames = 600;
+    constexpr float budgetMilliseconds = 2.0f;
+    constexpr float frameTime = 1.0f / 60.0f;
+
+    ParticlePool pool(particleCount);
+    std::vector<ParticleInstance> instances;
+    std::mt19937 benchmarkGenerator(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    const auto refill = [&]
+    {
+        while (pool.Size() < particleCount)
+            pool.Emit({
+                .position = {unit(benchmarkGenerator) * 10.0f, unit(benchmarkGenerator) + 1.0f, unit(benchmarkGenerator) * 3.0f},
+                .velocity = {unit(benchmarkGenerator) * 4.0f, unit(benchmarkGenerator) * 4.0f + 4.0f, unit(benchmarkGenerator) * 4.0f},
+                .lifetime = 0.5f + unit(benchmarkGenerator) * 0.25f,
+                .size = 0.1f,
+                .gravity = gravity,
+            });
+    };
+
+    std::vector<float> times;
+    times.reserve(frames);
+    for (int i = 0; i < frames; i++)
+    {
+        // Emission is outside the timed part, the game only emits a few particles per frame
+        refill();
+        const auto start = std::chrono::steady_clock::now();
+        pool.Simulate(frameTime, {-debugSettings.pathVelocity, 0.0f, 0.0f});
+        pool.Pack(instances);
+        times.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::ranges::sort(times);
+    float average = 0.0f;
+    for (const float time : times)
+        average += time / static_cast<float>(times.size());
+    std::cout << std::format("Particles: {} live, simulate + pack {:.3f} ms average, {:.3f} ms p99, {:.3f} ms worst (budget {:.1f} ms)\n", particleCount, average,
+                             times[times.size() * 99 / 100], times.back(), budgetMilliseconds);
+    return average <= budgetMilliseconds ? 0 : 1;
+}
+
+/// Cost per entity of the world matrix and AABB of 10k colliders, computed per entity (as before the cache) and batched.
+int RunTransformBenchmark()
+{
+    constexpr std::size_t entityCount = 10000;
+    constexpr int iterations = 200;
+
+    ComponentList<ECS::Components::Transform, ECS::Components::AABBCollider, ParentComponent>::Register(registry);
+    std::mt19937 benchmarkGenerator(1234);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (std::size_t i = 0; i < entityCount; i++)
+    {
+        const ECS::Entity e = registry.CreateEntity();
+        registry
+            .AddComponent(e, ECS::Components::Transform{
+                                 .translation = glm::vec3(unit(benchmarkGenerator), unit(benchmarkGenerator), unit(benchmarkGenerator)) * 50.0f,
+                                 .rotation = glm::angleAxis(unit(benchmarkGenerator) * 3.14f, glm::vec3(0.0f, 1.0f, 0.0f)),
+                                 .scale = glm::vec3(1.0f + unit(benchmarkGenerator) * 0.5f)
+        })
+            .AddComponent(e, ECS::Components::AABBCollider{.min = glm::vec3(-0.5f), .max = glm::vec3(0.5f)});
+    }
+    const std::vector<ECS::Entity> entities = registry.View<ECS::Components::Transform, ECS::Components::AABBCollider>();
+
+    // Nanoseconds per entity, averaged over every iteration
+    float sink = 0.0f;
+    const auto measure = [&entities](const std::function<void()> &run) -> float
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            run();
+        return std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<float>(iterations * entities.size());
+    };
+
+    const float perEntity = measure([&]
+    {
+        for (const ECS::Entity entity : entities)
+        {
+            const auto &transform = registry.GetComponent<ECS::Components::Transform>(entity);
+            const auto &collider = registry.GetComponent<ECS::Components::AABBCollider>(entity);
+            const glm::mat4 world = glm::translate(glm::mat4(1.0f), transform.translation) * glm::mat4_cast(transform.rotation) * glm::scale(glm::mat4(1.0f), transform.scale);
+            const auto worldAABB = collider.GetWorldAABB(transform);
+            sink += world[3][0] + worldAABB.min.x;
+        }
+    });
+
+    TransformBatch batch;
+    batch.Resize(entities.size());
+    for (std::size_t i = 0; i < entities.size(); i++)
+    {
+        const auto &transform = registry.GetComponent<ECS::Components::Transform>(entities[i]);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            batch[static_cast<TransformBatch::Stream>(TransformBatch::TranslationX + axis)][i] = transform.translation[axis];
+            batch[static_cast<TransformBatch::Stream>(TransformBatch::ScaleX + axis)][i] = transform.scale[axis];
+            batch[static_cast<TransformBatch::Stream>(TransformBatch::LocalMinX + axis)][i] = -0.5f;
+            batch[static_cast<TransformBatch::Stream>(TransformBatch::LocalMaxX + axis)][i] = 0.5f;
+        }
+        batch[TransformBatch::RotationX][i] = transform.rotation.x;
+        batch[TransformBatch::RotationY][i] = transform.rotation.y;
+        batch[TransformBatch::RotationZ][i] = transform.rotation.z;
+        batch[TransformBatch::RotationW][i] = transform.rotation.w;
+    }
+    const float scalarKernel = measure([&batch] { ComputeWorldTransformsScalar(batch); });
+    const float simdKernel = measure([&batch] { ComputeWorldTransforms(batch); });
+
+    // The whole system, gathering from the registry included
+    TransformCacheSystem cache;
+    const auto moveEntities = [&entities](const std::size_t stride)
+    {
+        for (std::size_t i = 0; i < entities.size(); i += stride)
+            registry.GetComponent<ECS::Components::Transform>(entities[i]).translation.x += 0.001f;
+    };
+    const float allDirty = measure([&]
+    {
+        moveEntities(1);
+        cache.Update(registry, 0.0f);
+    });
+    const float tenthDirty = measure([&]
+    {
+        moveEntities(10);
+        cache.Update(registry, 0.0f);
+    });
+    const float unchanged = measure([&] { cache.Update(registry, 0.0f); });
+
+    std::cout << std::format("Transforms ({} entities, ns per entity)\n"
+                             "  per entity matrix + GetWorldAABB: {:.2f}\n"
+                             "  batched kernel, scalar: {:.2f}\n"
+                             "  batched kernel, SIMD: {:.2f}\n"
+                             "  cache update, all dirty: {:.2f}\n"
+                             "  cache update, 10% dirty: {:.2f}\n"
+                             "  cache update, unchanged: {:.2f}\n",
+                             entities.size(), perEntity, scalarKernel, simdKernel, allDirty, tenthDirty, unchanged);
+    // Keeps the per entity loop from being optimized away
+    return sink == 0.12345f ? 1 : 0;
+}
+
+/// Hash of everything the simulation changes, a replay must always end with the same one.
+std::uint64_t HashGameState()
+{
+    std::vector<float> state = {metersRunned, static_cast<float>(gameScene)};
+    for (const auto entity : registry.View<ECS::Components::Transform>())
+    {
+        const auto &transform = registry.GetComponent<ECS::Components::Transform>(entity);
+        state.insert(state.end(), {transform.translation.x, transform.translation.y, transform.translation.z});
+    }
+    for (const auto entity : registry.View<RunnerComponent>())
+    {
+        const auto &runner = registry.GetComponent<RunnerComponent>(entity);
+        state.insert(state.end(), {static_cast<float>(runner.score), static_cast<float>(runner.obstacleHits), runner.velocity.y});
+    }
+    return Replay::HashState(state);
+}
+
 void LoadInGameEntities()
 {
     // region Entities
@@ -303,7 +807,17 @@ void LoadInGameEntities()
     })
         .AddComponent(player, RunnerComponent{})
         .AddComponent(player, ECS::Components::AABBCollider{.min = {-0.25f, -0.7f, -0.25f}, .max = {0.25f, 0.7f, 0.25f}})
-        .AddComponent(player, ECS::Components::AudioSource{});
+        .AddComponent(player, ECS::Components::AudioSource{})
+        .AddComponent(player, ParticleEmitterComponent{.effect = ParticleEffect::SpeedLines, .rate = 60.0f, .oneShot = false});
+
+    playerMesh = registry.CreateEntity();
+    registry
+        .AddComponent(playerMesh, ECS::Components::Transform{
+                                      .translation = {0.0f, -0.80f, 0.0f},
+                                      .rotation = glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+                                      .scale = glm::vec3(0.20f)
+    })
+        .AddComponent(playerMesh, ParentComponent{player});
 
     floorEntity = registry.CreateEntity();
     registry
@@ -330,65 +844,233 @@ void LoadInGameEntities()
             .AddComponent(e, PathComponent{})
             .AddComponent(e, ECS::Components::MeshRenderer{.model = &pathChunk01, .shader = &shader});
         lastPath = e;
+        GameStats::GetInstance()->Add(GameStat::PathsSpawned);
     }
     // endregion Entities
+    entitySignatures.Rebuild(registry);
+}
+
+/// Stress test scene, the load is spread over the first meters of the path in front of the game camera.
+void LoadBenchmarkEntities(const BenchmarkLoad &load)
+{
+    constexpr float benchmarkLength = 60.0f;
+    constexpr float laneWidth = 2.0f;
+    const auto spread = [](const int index, const int count) -> float
+    {
+        return benchmarkLength * (static_cast<float>(index) + 0.5f) / static_cast<float>(std::max(count, 1));
+    };
+
+    entityCommands.Clear();
+    registry.Reset();
+    GameStats::GetInstance()->Reset();
+    for (int i = 0; i < static_cast<int>(benchmarkLength / 2.0f); i++)
+    {
+        const ECS::Entity e = registry.CreateEntity();
+        registry
+            .AddComponent(e, ECS::Components::Transform{
+                                 .translation = {2.0f * static_cast<float>(i), 0.0f, 0.0f},
+                                 .scale = glm::vec3(0.1f)
+        })
+            .AddComponent(e, PathComponent{})
+            .AddComponent(e, ECS::Components::MeshRenderer{.model = &pathChunk01, .shader = &shader});
+        GameStats::GetInstance()->Add(GameStat::PathsSpawned);
+    }
+
+    // Obstacles and coins take the three lanes in turns, the prefabs are used in order
+    auto obstaclePrefab = obstacleGenComponents.begin();
+    for (int i = 0; i < load.obstacles; i++, obstaclePrefab++)
+    {
+        if (obstaclePrefab == obstacleGenComponents.end()) obstaclePrefab = obstacleGenComponents.begin();
+        const ObstacleInfo &info = obstaclePrefab->second;
+        const ECS::Entity obstacle = registry.CreateEntity();
+        registry.AddComponent(obstacle, ECS::Components::Transform{
+                                            .translation = {spread(i / 3, (load.obstacles + 2) / 3), info.transform.translation.y, static_cast<float>(i % 3 - 1) * laneWidth},
+                                            .rotation = info.transform.rotation,
+                                            .scale = info.transform.scale
+        })
+            .AddComponent(obstacle, ECS::Components::AABBCollider{.min = info.collider.min, .max = info.collider.max})
+            .AddComponent(obstacle, info.meshRenderer)
+            .AddComponent(obstacle, info.lod)
+            .AddComponent(obstacle, ObstacleComponent{});
+    }
+
+    for (int i = 0; i < load.coins; i++)
+    {
+        const ECS::Entity coin = registry.CreateEntity();
+        registry
+            .AddComponent(coin, ECS::Components::Transform{
+                                    .translation = {spread(i / 3, (load.coins + 2) / 3), 1.0f, static_cast<float>(i % 3 - 1) * laneWidth},
+                                    .scale = glm::vec3(0.8f)
+        })
+            .AddComponent(coin, ECS::Components::MeshRenderer{.model = &coinModel, .shader = &shader})
+            .AddComponent(coin, ECS::Components::AABBCollider{.min = glm::vec3(-0.25f), .max = glm::vec3(0.25f)})
+            .AddComponent(coin, CoinComponent{5});
+    }
+
+    // Buildings alternate between both sides of the road
+    auto buildingPrefab = buildingGenComponents.begin();
+    const glm::quat leftRotation = glm::quat_cast(glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), {0, 1, 0}));
+    for (int i = 0; i < load.buildings; i++, buildingPrefab++)
+    {
+        if (buildingPrefab == buildingGenComponents.end()) buildingPrefab = buildingGenComponents.begin();
+        const BuildingInfo &info = buildingPrefab->second;
+        const bool left = i % 2 == 0;
+        const ECS::Entity building = registry.CreateEntity();
+        registry.AddComponent(building, ECS::Components::Transform{
+                                            .translation = {spread(i / 2, (load.buildings + 1) / 2), 0.0f, left ? buildingSideOffset : -buildingSideOffset},
+                                            .rotation = left ? leftRotation : info.transform.rotation,
+                                            .scale = info.transform.scale
+        })
+            .AddComponent(building, info.meshRenderer)
+            .AddComponent(building, info.lod)
+            .AddComponent(building, BuildingComponent{});
+    }
+    entitySignatures.Rebuild(registry);
+    const auto stats = GameStats::GetInstance();
+    stats->Add(GameStat::ObstaclesSpawned, static_cast<std::uint64_t>(std::max(load.obstacles, 0)));
+    stats->Add(GameStat::CoinsSpawned, static_cast<std::uint64_t>(std::max(load.coins, 0)));
+    stats->Add(GameStat::BuildingsSpawned, static_cast<std::uint64_t>(std::max(load.buildings, 0)));
 }
 
-void renderScene(Shader &shd)
+void BuildMenuScene()
 {
-    glm::mat4 model;
     // region MainMenuScene
-    // draw paths
+    menuScene.clear();
+
+    // paths
     for (unsigned int i = 0; i < 15; i++)
     {
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, {2.0f * static_cast<float>(i), 0.0f, 0.0f});
-        model = glm::scale(model, glm::vec3(0.1f));
-        shd.Set<4, 4>("model", model);
-        pathChunk01.Render(shd);
+        const glm::mat4 model = glm::translate(glm::mat4(1.0f), {2.0f * static_cast<float>(i), 0.0f, 0.0f});
+        menuScene.push_back({&pathChunk01, glm::scale(model, glm::vec3(0.1f))});
     }
 
     // Buildings
-    model = glm::translate(glm::mat4(1.0f), {5.0f, 0.0f, -9.0f});
-    model = glm::scale(model, glm::vec3(0.30f));
-    shd.Set<4, 4>("model", model);
-    oxxoStore.Render(shd);
-
-    model = glm::translate(glm::mat4(1.0f), {15.0f, 0.0f, -9.0f});
-    model = glm::scale(model, glm::vec3(0.8f));
-    shd.Set<4, 4>("model", model);
-    buildingModel.Render(shd);
-
-    model = glm::translate(glm::mat4(1.0f), {25.0f, 0.0f, -9.0f});
-    model = glm::scale(model, glm::vec3(1.4f));
-    shd.Set<4, 4>("model", model);
-    storeModel.Render(shd);
-
-    // Render Ice Cream Cart
-    model = glm::translate(glm::mat4(1.0f), {5.2f, 0.65f, -1.45f});
+    menuScene.push_back({&oxxoStore, glm::scale(glm::translate(glm::mat4(1.0f), {5.0f, 0.0f, -9.0f}), glm::vec3(0.30f))});
+    menuScene.push_back({&buildingModel, glm::scale(glm::translate(glm::mat4(1.0f), {15.0f, 0.0f, -9.0f}), glm::vec3(0.8f))});
+    menuScene.push_back({&storeModel, glm::scale(glm::translate(glm::mat4(1.0f), {25.0f, 0.0f, -9.0f}), glm::vec3(1.4f))});
+
+    // Ice Cream Cart
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), {5.2f, 0.65f, -1.45f});
     model = glm::rotate(model, glm::radians(120.0f), {0, 1, 0});
     model = glm::rotate(model, glm::radians(-90.0f), {1, 0, 0});
-    model = glm::scale(model, glm::vec3(0.8f));
-    shd.Set<4, 4>("model", model);
-    iceCreamCart.Render(shd);
+    menuScene.push_back({&iceCreamCart, glm::scale(model, glm::vec3(0.8f))});
 
     // Tsuru model
     model = glm::translate(glm::mat4(1.0f), {8.0f, 0.10f, -1.6f});
     model = glm::rotate(model, glm::radians(90.0f), {0, 1, 0});
-    model = glm::scale(model, glm::vec3(0.5f));
-    shd.Set<4, 4>("model", model);
-    tsuruCar.Render(shd);
-
-    auto finalBones = playerAnimator.GetFinalBoneMatrices();
-    model = glm::translate(glm::mat4(1.0f), {4.0f, 0.0f, -0.5f});
-    model = glm::scale(model, glm::vec3(0.15f));
-    shd.Set<4, 4>("model", model);
-    for (unsigned int i = 0; i < finalBones.size(); i++)
-        shd.Set<4, 4>(std::format("bones[{}]", i).c_str(), finalBones[i]);
+    menuScene.push_back({&tsuruCar, glm::scale(model, glm::vec3(0.5f))});
+    // endregion MainMenuScene
+}
+
+void renderStaticScene(Shader &shd)
+{
+    for (const auto &[sceneModel, transform] : menuScene)
+    {
+        shd.Set<4, 4>("model", transform);
+        sceneModel->Render(shd);
+    }
+}
+
+glm::mat4 menuPlayerModel()
+{
+    const glm::mat4 model = glm::translate(glm::mat4(1.0f), {4.0f, 0.0f, -0.5f});
+    return glm::scale(model, glm::vec3(0.15f));
+}
+
+void renderDynamicScene(Shader &shd, const std::vector<glm::mat4> &bones)
+{
+    // Array elements take consecutive locations, a shader without bones skips the uploads
+    const int bonesLocation = shd.GetUniformLocation("bones[0]");
+    const std::size_t boneCount = bonesLocation < 0 ? 0 : std::min<std::size_t>(bones.size(), MAX_BONES);
+    shd.Set<4, 4>("model", menuPlayerModel());
+    for (std::size_t i = 0; i < boneCount; i++)
+        shd.Set<4, 4>(bonesLocation + static_cast<int>(i), bones[i]);
     lowPolyManModel.Render(shd);
 
-    for (unsigned int i = 0; i < MAX_BONES; i++)
-        shd.Set<4, 4>(std::format("bones[{}]", i).c_str(), glm::mat4(1.0f));
+    // Only the bones set above need to go back to the identity
+    for (std::size_t i = 0; i < boneCount; i++)
+        shd.Set<4, 4>(bonesLocation + static_cast<int>(i), glm::mat4(1.0f));
+}
+
+void submitMenuScene(RenderQueue &queue, const std::vector<glm::mat4> &playerBones)
+{
+    for (const auto &[sceneModel, transform] : menuScene)
+        queue.Submit(RenderPass::Opaque, shader, *sceneModel, transform);
+
+    queue.Submit(RenderPass::Opaque, shader, lowPolyManModel, menuPlayerModel(), playerBones.data(), static_cast<std::uint32_t>(playerBones.size()));
+}
+
+void drawSkybox(void *data)
+{
+    const auto &context = *static_cast<FrameDrawContext *>(data);
+    context.skybox
+        ->BeginRender(skyboxShader)
+        .SetProjection(context.projection)
+        .SetView(context.view)
+        .Render();
+}
+
+void drawGrid(void *data)
+{
+    const auto &context = *static_cast<FrameDrawContext *>(data);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    gridShader.Use();
+    gridShader.Set<4, 4>("uVP", context.projection * context.view);
+    gridShader.Set<3>("cameraPosition", context.cameraPosition);
+    plane.Render();
+    glDisable(GL_BLEND);
+}
+
+void drawHitboxes(void *data)
+{
+    const auto &context = *static_cast<FrameDrawContext *>(data);
+    const glm::vec3 groundedColor(0.0f, 1.0f, 1.0f);
+    const glm::vec3 collidingColor(1.0f, 0.0f, 0.0f);
+    const glm::vec3 idleColor(1.0f, 1.0f, 0.0f);
+
+    // Only to differentiate floor&player grounding from other colliders, resolved once instead of per collider
+    bool playerGrounded = false;
+    bool floorUnderPlayer = false;
+    if (registry.HasComponent<ECS::Components::AABBCollider>(player))
+    {
+        const auto &playerCollider = registry.GetComponent<ECS::Components::AABBCollider>(player);
+        playerGrounded = playerCollider.collidingEntities.size() == 1 && playerCollider.collidingEntities.front() == floorEntity;
+    }
+    if (registry.HasComponent<ECS::Components::AABBCollider>(floorEntity))
+    {
+        const auto &floorCollider = registry.GetComponent<ECS::Components::AABBCollider>(floorEntity);
+        floorUnderPlayer = std::ranges::find(floorCollider.collidingEntities, player) != floorCollider.collidingEntities.end();
+    }
+
+    for (const ECS::Entity colliderEntity : registry.View<ECS::Components::AABBCollider, ECS::Components::Transform>())
+    {
+        const auto &transform = registry.GetComponent<ECS::Components::Transform>(colliderEntity);
+        const auto &collider = registry.GetComponent<ECS::Components::AABBCollider>(colliderEntity);
+        // The box the collision system tests, not the cached render bounds
+        const auto worldCollider = collider.GetWorldAABB(transform);
+
+        const bool grounded = (colliderEntity == player && playerGrounded) || (colliderEntity == floorEntity && floorUnderPlayer);
+        debugDraw.Box(worldCollider.min, worldCollider.max, grounded ? groundedColor : collider.isColliding ? collidingColor : idleColor);
+    }
+
+    for (const ECS::Entity obbEntity : registry.View<ECS::Components::OBBCollider, ECS::Components::Transform>())
+    {
+        const auto &transform = registry.GetComponent<ECS::Components::Transform>(obbEntity);
+        const auto &collider = registry.GetComponent<ECS::Components::OBBCollider>(obbEntity);
+        const auto worldOBB = collider.GetWorldOBB(transform);
+
+        debugDraw.OBB(worldOBB.center, worldOBB.rotation, worldOBB.halfExtents, collider.isColliding ? collidingColor : idleColor);
+    }
+
+    if (registry.HasComponent<ECS::Components::Transform>(player))
+    {
+        const auto &playerTransform = registry.GetComponent<ECS::Components::Transform>(player);
+        debugDraw.Ray(playerTransform.translation, {0.0f, -1.0f, 0.0f}, 1.0f, playerGrounded ? groundedColor : idleColor);
+        debugDraw.Text(playerTransform.translation + glm::vec3(0.0f, 1.0f, 0.0f), playerGrounded ? "grounded" : "airborne");
+    }
+
+    debugDraw.Flush(debugShader, context.projection * context.view, context.font);
 }
 
 void GenerateObstaclesInfo()
@@ -398,7 +1080,8 @@ void GenerateObstaclesInfo()
                                                 .rotation = glm::quat_cast(glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), {0, 1, 0})),
                                                 .scale = glm::vec3(0.7f)},
         .collider = ECS::Components::AABBCollider{.min = {-3.01, 0, -0.96}, .max = {3.01, 2.68, 0.96}},
-        .meshRenderer = ECS::Components::MeshRenderer{.model = &microbus, .shader = &shader}
+        .meshRenderer = ECS::Components::MeshRenderer{.model = &microbus, .shader = &shader},
+        .lod = lodLibrary.Load(microbus, modelsRoot + "Microbus/Microbus.obj")
     };
 
     obstacleGenComponents["iceCreamCart"] = {
@@ -407,7 +1090,8 @@ void GenerateObstaclesInfo()
                                                 .rotation = glm::quat_cast(glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), {1, 0, 0})),
                                                 .scale = glm::vec3(0.8f)},
         .collider = ECS::Components::AABBCollider{.min = glm::vec3(-0.8f), .max = glm::vec3(0.8f)},
-        .meshRenderer = ECS::Components::MeshRenderer{.model = &iceCreamCart, .shader = &shader}
+        .meshRenderer = ECS::Components::MeshRenderer{.model = &iceCreamCart, .shader = &shader},
+        .lod = lodLibrary.Load(iceCreamCart, modelsRoot + "IceCreamCart/IceCreamCart.fbx")
     };
 
     obstacleGenComponents["tsuru"] = {
@@ -416,7 +1100,8 @@ void GenerateObstaclesInfo()
                                                 .rotation = glm::quat_cast(glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), {0, 1, 0})),
                                                 .scale = glm::vec3(0.5f)},
         .collider = ECS::Components::AABBCollider{.min = {-3.3f, 0.0f, -1.0f}, .max = {2.3f, 1.0f, 1.0f}},
-        .meshRenderer = ECS::Components::MeshRenderer{.model = &tsuruCar, .shader = &shader}
+        .meshRenderer = ECS::Components::MeshRenderer{.model = &tsuruCar, .shader = &shader},
+        .lod = lodLibrary.Load(tsuruCar, modelsRoot + "Tsuru/Tsuru.obj")
     };
 }
 
@@ -426,24 +1111,58 @@ void GenerateBuildingsInfo()
         .transform = {
                       .scale = glm::vec3(0.30f)},
         .meshRenderer = {.model = &oxxoStore, .shader = &shader},
-        .buildingComponent = {.border = {1.0f, 1.0f, 1.0f}}
+        .buildingComponent = {.border = {1.0f, 1.0f, 1.0f}},
+        .lod = lodLibrary.Load(oxxoStore, modelsRoot + "OxxoStore/OxxoStore.obj")
     };
     buildingGenComponents["store"] = {
         .transform = {
                       .scale = glm::vec3(1.0f)},
         .meshRenderer = {.model = &storeModel, .shader = &shader},
-        .buildingComponent = {.border = {1.0f, 1.0f, 1.0f}}
+        .buildingComponent = {.border = {1.0f, 1.0f, 1.0f}},
+        .lod = lodLibrary.Load(storeModel, modelsRoot + "Store/Store.obj")
     };
     buildingGenComponents["lpbuild"] = {
         .transform = {
                       .scale = glm::vec3(1.0f)},
         .meshRenderer = {.model = &buildingModel, .shader = &shader},
-        .buildingComponent = {.border = {1.0f, 1.0f, 1.0f}}
+        .buildingComponent = {.border = {1.0f, 1.0f, 1.0f}},
+        .lod = lodLibrary.Load(buildingModel, modelsRoot + "LowPolyBuilding/otherbuilding.obj")
     };
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+    const LaunchOptions options = ParseArguments(argc, argv);
+    if (options.particleBenchmark)
+        return RunParticleBenchmark();
+    if (options.transformBenchmark)
+        return RunTransformBenchmark();
+
+    Replay replay;
+    if (!options.replayPath.empty() && !replay.StartPlayback(options.replayPath))
+        return 1;
+    const bool replaying = replay.GetMode() == Replay::Mode::Playing;
+    const std::uint32_t seed = replaying ? replay.GetSeed() : options.seed.value_or(std::random_device{}());
+    generator.seed(seed);
+    if (!options.recordPath.empty() && !replaying)
+        replay.StartRecording(options.recordPath, seed);
+
+    if (options.offscreen != OffscreenApi::None && !ConfigureOffscreenContext(options.offscreen))
+        return 1;
+
+    for (const auto &[tag, megabytes] : memoryBudgets)
+        MemoryTracker::SetBudget(tag, megabytes * 1024 * 1024);
+#ifdef ENABLE_MEMORY_TRACKING
+    // ImGui uses malloc by default, through operator new its memory is charged to Gui. Set before the context exists
+    ImGui::SetAllocatorFunctions(
+        [](const std::size_t size, [[maybe_unused]] void *userData) -> void *
+        {
+            const MemoryTagScope scope(MemoryTag::Gui);
+            return ::operator new(size);
+        },
+        [](void *pointer, [[maybe_unused]] void *userData) { ::operator delete(pointer); });
+#endif
+
     Window window(1280, 720, "Proyecto Final CGA");
 
     if (!window.Init())
@@ -452,42 +1171,69 @@ int main()
         return 1;
     }
 
+    // Headless runs still need the GL context, only the window is hidden
+    const bool benchmarking = !options.benchmarkPath.empty() && !replaying;
+    if (options.headless && (replaying || benchmarking))
+        glfwHideWindow(glfwGetCurrentContext());
+    if (options.offscreen != OffscreenApi::None && !replaying && !benchmarking)
+        std::cerr << "\033[33mOffscreen run without --replay or --benchmark, it only ends when the process is stopped\033[0m\n";
+
     LoadSettings();
 
-    registry.RegisterComponent<ECS::Components::Transform>();
-    registry.RegisterComponent<ECS::Components::MeshRenderer>();
-    registry.RegisterComponent<ECS::Components::AABBCollider>();
-    registry.RegisterComponent<ECS::Components::AudioSource>();
-    registry.RegisterComponent<ECS::Components::AudioListener>();
-    registry.RegisterComponent<RunnerComponent>();
-    registry.RegisterComponent<FloorComponent>();
-    registry.RegisterComponent<PathComponent>();
-    registry.RegisterComponent<ObstacleComponent>();
-    registry.RegisterComponent<BuildingComponent>();
-    registry.RegisterComponent<CoinComponent>();
+    // Replays and benchmarks run as fast as they can, vsync would hide the frame times
+    if (replaying || benchmarking)
+        window.EnableVsync(false);
+
+    GameComponents::Register(registry);
+    CaptureGame(initialGame);
     systemManager.RegisterSystem<ECS::Systems::CollisionSystem>();
-    systemManager.RegisterSystem<ECS::Systems::RenderSystem>();
     systemManager.RegisterSystem<ECS::Systems::AudioSystem>();
     systemManager.RegisterSystem<RunnerSystem>();
     systemManager.RegisterSystem<CoinSystem>();
+    systemManager.RegisterSystem<ParticleSystem>();
+    // Last, the meshes are submitted with the transforms the other systems left this frame
+    systemManager.RegisterSystem<TransformCacheSystem>();
+    systemManager.RegisterSystem<MeshSubmitSystem>();
 
     auto runnerSystem = systemManager.GetSystem<RunnerSystem>();
     runnerSystem->SetEnabled(false);
+    runnerSystem->SetSignatures(&entitySignatures);
 
     auto audioSystem = systemManager.GetSystem<ECS::Systems::AudioSystem>();
 
+    // Temporaries of the frame, released after EndRenderPass
+    FrameArena frameArena(1024 * 1024);
+    // Every draw of the main view goes through the queue, the ECS meshes are submitted during UpdateAll
+    RenderQueue renderQueue(frameArena);
+    auto meshSubmitSystem = systemManager.GetSystem<MeshSubmitSystem>();
+    meshSubmitSystem->SetRenderQueue(&renderQueue);
+    meshSubmitSystem->SetLodLibrary(&lodLibrary);
+    meshSubmitSystem->SetSignatures(&entitySignatures);
+    auto transformCache = systemManager.GetSystem<TransformCacheSystem>();
+    meshSubmitSystem->SetTransformCache(transformCache.get());
+    auto particleSystem = systemManager.GetSystem<ParticleSystem>();
+    particleSystem->SetRenderQueue(&renderQueue);
+    particleSystem->SetCommandBuffer(&entityCommands);
+    entityCommands.SetObserver(&entitySignatures);
+    auto coinSystem = systemManager.GetSystem<CoinSystem>();
+    coinSystem->SetCommandBuffer(&entityCommands);
+    const auto gameStats = GameStats::GetInstance();
+
     resources.ScanResources();
     Resources::ResourceManager::InitDefaultResources();
 
-    oxxoStore.Load();
-    pathChunk01.Load();
-    tsuruCar.Load();
-    iceCreamCart.Load();
-    microbus.Load();
-    lowPolyManModel.Load();
-    coinModel.Load();
-    storeModel.Load();
-    buildingModel.Load();
+    {
+        const MemoryTagScope modelMemory(MemoryTag::Models);
+        // OBJ models are uploaded from their optimised copy, cooked when missing or older than the source
+        for (const auto &[gameModel, relativePath] : gameModels)
+        {
+            const std::string loadedPath = MeshOptimizer::CookOptimized(modelsRoot + relativePath);
+            *gameModel = Model(loadedPath);
+            gameModel->Load();
+            // Replaced by the source count of the LOD chains, the other models keep this one
+            lodLibrary.RecordTriangles(*gameModel, MeshOptimizer::CountTriangles(loadedPath));
+        }
+    }
 
     playerAnimation = lowPolyManModel.GetAnimation(2);
     if (playerAnimation)
@@ -495,6 +1241,7 @@ int main()
         playerAnimator.PlayAnimation(playerAnimation);
     }
 
+    BuildMenuScene();
     GenerateObstaclesInfo();
     GenerateBuildingsInfo();
 
@@ -508,7 +1255,10 @@ int main()
 	    "./assets/textures/skybox/sky_cubemap/nz.png"
 	});
     // clang-format on
-    skybox.Load();
+    {
+        const MemoryTagScope textureMemory(MemoryTag::Textures);
+        skybox.Load();
+    }
 
     shader = *resources.GetShader("base");
     skyboxShader = *resources.GetShader("skybox_shader");
@@ -517,6 +1267,25 @@ int main()
     debugShader = *resources.GetShader("debug");
     depthShader = *resources.GetShader("depth_shader");
     pointDepthShader = *resources.GetShader("point_depth_shader");
+    particleShader = *resources.GetShader("particle");
+    particleSystem->Init(&particleShader, assetsRoot + "textures/particle.png");
+
+    // Base shader permutations, PCF radius x static/skinned, loaded from the binary cache after the first launch
+    ShaderVariantCache shaderVariants;
+    shaderVariants.Init(shadersRoot, shaderCachePath);
+    const auto getBaseVariants = [&shaderVariants](const int pcfRadius) -> std::array<unsigned int, 2>
+    {
+        const std::vector<std::string> defines = {"POINT_SHADOWS true", std::format("PCF_RADIUS {}", std::clamp(pcfRadius, 0, 2))};
+        std::vector<std::string> skinnedDefines = defines;
+        skinnedDefines.emplace_back("SKINNED");
+        return {shaderVariants.Get("base", defines), shaderVariants.Get("base", skinnedDefines)};
+    };
+    for (int pcfRadius = 0; pcfRadius <= 2; pcfRadius++)
+        getBaseVariants(pcfRadius);
+    // The default program and the two variants drawn this frame, resolved again when the PCF radius or the programs change
+    std::array<BaseUniforms, 3> baseUniforms{};
+    int resolvedPcfRadius = -1;
+    std::uint32_t resolvedVariantsVersion = 0;
 
     Framebuffer pixelFrameBuffer(fbPixelShader, window.GetWidth(), window.GetHeight());
     pixelFrameBuffer.SetMaxResolution(WIDTH, pixelFbResolution);
@@ -525,11 +1294,28 @@ int main()
 
     window.AddFramebuffer(&pixelFrameBuffer);
 
-    DepthMap depthMap;
-    depthMap.Init(2048, 2048);
+    DynamicResolution dynamicResolution(debugSettings.dynamicResolutionMin, debugSettings.dynamicResolutionMax, pixelFbResolution);
+    GpuTimer frameTimer;
+    frameTimer.Init();
+
+    FrameCapture frameCapture;
+    frameCapture.Init();
+    // With a replay this records the same frames on every run
+    if (!options.capturePath.empty())
+        frameCapture.StartRecording(options.capturePath);
+    int screenshotCount = 0;
 
+    // Each shadow map keeps a static layer that is copied into the final map before drawing the dynamic casters
+    CascadedShadowMap cascadedShadowMap;
+    cascadedShadowMap.Init(shadowCascadeResolution, shadowCascades);
+
+    DepthCubemap staticDepthCubemap;
+    staticDepthCubemap.Init(pointShadowMapResolution, pointShadowMapResolution);
     DepthCubemap depthCubemap;
-    depthCubemap.Init(1024, 1024);
+    depthCubemap.Init(pointShadowMapResolution, pointShadowMapResolution);
+
+    ShadowCache directionalShadowCache;
+    ShadowCache pointShadowCache;
 
     Camera freeCamera({2.0f, 2.0f, 2.0f}, {0.0f, 1.0f, 0.0f});
     Camera menuCamera({3.0f, 1.0f, 2.8f}, {0.0f, 1.0f, 0.0f},
@@ -548,24 +1334,10 @@ int main()
     freeCamera.SetMoveSpeed(debugSettings.cameraMoveSpeed);
     freeCamera.SetTurnSpeed(debugSettings.cameraTurnSpeed);
 
-    keyboard.AddCallback(GLFW_KEY_P, [&freeCamera]() -> void
-                         {
-                             if (cameraChange.event) return;
-                             cameraChange.event = true;
-                             useFreeCamera = !useFreeCamera;
-                             if (useFreeCamera)
-                             {
-                                 previousUsedCamera = mainCamera;
-                                 mainCamera = &freeCamera;
-                             }
-                             else
-                                 mainCamera = previousUsedCamera;
-                         });
-
     // mouse.ToggleMouse(enableCursor);
     window.SetMouseStatus(enableCursor);
 
-    StorageBufferDynamicArray<Lights::PointLight> pointLights(3);
+    DynamicStorageBuffer<Lights::PointLight> pointLights(3);
     pointLights.Add({
         .position = {0.0f, 3.0f, 0.0f, 0.0f},
         .ambient = {0.1f, 0.1f, 0.1f, 0.0f},
@@ -607,7 +1379,10 @@ int main()
         .isTurnedOn = true
     });
 
-    StorageBufferDynamicArray<Lights::DirectionalLight> directionalLights(4);
+    ClusteredLights clusteredLights;
+    clusteredLights.Init();
+
+    DynamicStorageBuffer<Lights::DirectionalLight> directionalLights(4);
     directionalLights.Add({
         .direction = {0.0f,  -1.0f, 0.0f },
         .ambient = {0.08f, 0.08f, 0.08f},
@@ -630,24 +1405,202 @@ int main()
                        0.30f);
     fontArial.Init();
 
-    ConfigureKeys(window);
+    ConfigureKeys();
 
     plane.Init();
-    cube.Init();
+    debugDraw.Init();
+
+    // Hot reload, the files are read on the watcher thread and swapped at the start of the next frame
+    const std::unordered_map<std::string, Shader *> shadersByName = {
+        {"base",               &shader          },
+        {"skybox_shader",      &skyboxShader    },
+        {"infinite_grid",      &gridShader      },
+        {"fb_pixel",           &fbPixelShader   },
+        {"debug",              &debugShader     },
+        {"depth_shader",       &depthShader     },
+        {"point_depth_shader", &pointDepthShader},
+        {"particle",           &particleShader  },
+    };
+    int hotReloads = 0;
+    FileWatcher fileWatcher;
+    fileWatcher.Add(shadersRoot, [&shadersByName, &renderQueue, &shaderVariants](const std::filesystem::path &path) -> FileWatcher::ApplyFunction
+                    {
+                        const std::string name = path.stem().string();
+                        const auto it = shadersByName.find(name);
+                        if (it == shadersByName.end()) return nullptr;
+                        // The engine Shader reads its own files in ReloadShader, the variants compile from the sources read here
+                        return [&renderQueue, &shaderVariants, reloaded = it->second, path, name,
+                                sources = ShaderVariantCache::ReadSources(path.parent_path(), name)]() -> void
+                        {
+                            reloaded->ReloadShader();
+                            shaderVariants.Invalidate(name, sources);
+                            renderQueue.ResetShaderCache();
+                            std::cout << "Reloaded " << path << '\n';
+                        };
+                    });
+    fileWatcher.Add(assetsRoot, [&directionalShadowCache, &pointShadowCache](const std::filesystem::path &path) -> FileWatcher::ApplyFunction
+                    {
+                        // A texture or material change reloads every model in the same directory
+                        struct ChangedModel
+                        {
+                            Model *model;
+                            std::string source;
+                            std::string path;
+                            std::size_t triangles;
+                        };
+                        std::vector<ChangedModel> changed;
+                        for (const auto &[gameModel, relativePath] : gameModels)
+                        {
+                            const std::filesystem::path modelPath = std::filesystem::path(modelsRoot + relativePath).lexically_normal();
+                            // The cooked files are written by the reload itself
+                            const std::string stem = path.stem().string();
+                            if (modelPath.parent_path() == path.parent_path() && stem.find("_lod") == std::string::npos && !stem.ends_with("_opt"))
+                            {
+                                // Parsing, optimising and writing the cooked copies stay on this thread
+                                const std::string loadedPath = MeshOptimizer::CookOptimized(modelPath.string());
+                                LodLibrary::Cook(modelPath.string());
+                                changed.push_back({gameModel, modelPath.string(), loadedPath, MeshOptimizer::CountTriangles(loadedPath)});
+                            }
+                        }
+                        if (changed.empty()) return nullptr;
+                        // Model::Load imports the prepared file and uploads it in one engine call, it needs the GL context
+                        return [&directionalShadowCache, &pointShadowCache, changed]() -> void
+                        {
+                            for (const auto &[gameModel, source, loadedPath, triangles] : changed)
+                            {
+                                *gameModel = Model(loadedPath);
+                                gameModel->Load();
+                                lodLibrary.RecordTriangles(*gameModel, triangles);
+                                lodLibrary.Reload(*gameModel, source);
+                                std::cout << "Reloaded " << loadedPath << '\n';
+                            }
+                            // The static props are in the cached shadow layers
+                            directionalShadowCache.Invalidate();
+                            pointShadowCache.Invalidate();
+                        };
+                    });
+    fileWatcher.Add(debugSettingsPath, [&window, &freeCamera](const std::filesystem::path &path) -> FileWatcher::ApplyFunction
+                    {
+                        std::ifstream settingsStream(path);
+                        const nlohmann::json data = nlohmann::json::parse(settingsStream, nullptr, false);
+                        if (data.is_discarded()) return nullptr;
+                        return [&window, &freeCamera, settings = data.get<DebugSettings>()]() -> void
+                        {
+                            debugSettings = settings;
+                            window.EnableVsync(debugSettings.enableVsync);
+                            freeCamera.SetMoveSpeed(debugSettings.cameraMoveSpeed);
+                            freeCamera.SetTurnSpeed(debugSettings.cameraTurnSpeed);
+                            std::cout << "Reloaded debug settings\n";
+                        };
+                    });
+    fileWatcher.Start();
 
     glm::mat4 view;
     glm::mat4 projection;
+    FrameDrawContext frameContext{.skybox = &skybox, .font = &fontArial};
+    // Kept alive until the queue is executed, the player command points to it
+    std::vector<glm::mat4> playerBones;
+
+    FrameProfiler profiler;
+    BenchmarkSweep benchmark;
+    // Extra animated runners of the benchmark, they are not entities so the game systems ignore them
+    std::vector<SkinnedAnimator> benchmarkRunners;
+    std::vector<std::vector<glm::mat4>> benchmarkRunnerBones;
+    const std::size_t scenePointLights = pointLights.Size();
+    std::string hudText;
+    std::uint64_t frameAllocations = 0;
+    if (benchmarking)
+    {
+        benchmark.Start(options.benchmarkPath);
+        gameScene = BENCHMARK;
+        mainCamera = &gameCamera;
+    }
 
     // * ===================================================================== *
     // *                             GAME LOOP                                 *
     // * ===================================================================== *
     while (!window.ShouldClose())
     {
+        const std::uint64_t allocationsAtFrameStart = AllocationCounter::GetCount();
         auto now = static_cast<float>(glfwGetTime());
         deltaTime = now - lastTime;
         lastTime = now;
 
+        profiler.BeginFrame();
         joystick.Update();
+        actions.BeginFrame();
+
+        if (benchmark.BeginFrame())
+        {
+            const BenchmarkLoad load = benchmark.GetLoad();
+            LoadBenchmarkEntities(load);
+
+            while (pointLights.Size() > scenePointLights)
+                pointLights.Remove(pointLights.Size() - 1);
+            for (int i = 0; i < load.pointLights; i++)
+            {
+                pointLights.Add({
+                    .position = {60.0f * (static_cast<float>(i) + 0.5f) / static_cast<float>(load.pointLights), 3.0f, static_cast<float>(i % 3 - 1) * 4.0f, 0.0f},
+                    .ambient = {0.1f, 0.1f, 0.1f, 0.0f},
+                    .diffuse = {0.9f, 0.7f, 0.7f, 0.0f},
+                    .specular = {1.0f, 1.0f, 1.0f, 0.0f},
+                    .constant = 1.0f,
+                    .linear = 0.09f,
+                    .quadratic = 0.032f,
+                    .isTurnedOn = true
+                });
+            }
+
+            benchmarkRunners.resize(static_cast<std::size_t>(load.runners));
+            benchmarkRunnerBones.resize(benchmarkRunners.size());
+            for (auto &runner : benchmarkRunners)
+                if (SkinnedAnimation *runAnimation = lowPolyManModel.GetAnimation(7)) runner.PlayAnimation(runAnimation);
+        }
+        else if (benchmark.IsFinished() && !window.ShouldClose())
+        {
+            benchmark.Write();
+            window.SetShouldClose(true);
+        }
+        // A replay overrides the live actions and simulates with the recorded delta time
+        deltaTime = replay.Tick(actions, deltaTime);
+        if (replay.IsFinished())
+            window.SetShouldClose(true);
+
+        // region Special keys handle
+        if (actions.WasPressed(Action::Quit))
+            window.SetShouldClose(true);
+        if (actions.WasPressed(Action::ToggleCursor))
+        {
+            enableCursor = !enableCursor;
+            mouse.ToggleMouse(enableCursor);
+            window.SetMouseStatus(enableCursor);
+        }
+        if (actions.WasPressed(Action::ToggleFullscreen))
+            window.ToggleFullscreen();
+        if (actions.WasPressed(Action::ToggleDebugGui))
+            showDebugGui = !showDebugGui;
+        if (actions.WasPressed(Action::Screenshot))
+            frameCapture.RequestScreenshot(std::format("screenshots/screenshot-{}-{}.png", seed, screenshotCount++));
+        if (actions.WasPressed(Action::ToggleFreeCamera))
+        {
+            useFreeCamera = !useFreeCamera;
+            if (useFreeCamera)
+            {
+                previousUsedCamera = mainCamera;
+                mainCamera = &freeCamera;
+            }
+            else
+                mainCamera = previousUsedCamera;
+        }
+        // endregion
+
+        hotReloads += fileWatcher.ApplyPending();
+
+        // Upload the light changes made during the last frame, at most one write per buffer
+        pointLights.Flush();
+        directionalLights.Flush();
+
+        frameTimer.Begin();
 
         if (fpsCounter <= 1)
         {
@@ -661,47 +1614,110 @@ int main()
             fpsCount = 0;
         }
 
-        // 1. render depth of scene to texture (from light's perspective)
+        // The camera is updated first, the shadow cascades are fitted to its frustum
+        mainCamera->Move(deltaTime);
+        view = mainCamera->GetLookAt();
+        projection = glm::perspective(glm::radians(cameraFov), pixelFrameBuffer.GetAspect(), cameraNearPlane, cameraFarPlane);
+
+        profiler.Begin("shadows");
+        MemoryTracker::SetCurrentTag(MemoryTag::Rendering);
+        directionalShadowCache.BeginFrame();
+        pointShadowCache.BeginFrame();
+        if (!enableShadowCache)
+        {
+            directionalShadowCache.Invalidate();
+            pointShadowCache.Invalidate();
+        }
+
+        // Only the animated player casts dynamic shadows, everything else in the scene is static
+        // The bones of the last update, what the animator would return until the next one
+        const std::size_t dynamicCastersHash = ShadowCache::Hash(playerBones, ShadowCache::Hash(menuPlayerModel()));
+
+        // 1. render depth of scene to the shadow cascades (from light's perspective)
         // --------------------------------------------------------------
-        glm::mat4 lightProjection, lightView;
-        glm::mat4 lightSpaceMatrix;
-        float near_plane = 1.0f, far_plane = 7.5f;
-        lightProjection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, near_plane, far_plane);
-        lightView = glm::lookAt(-directionalLights[0].direction, glm::vec3(0.0f), glm::vec3(0.0, 1.0, 0.0));
-        lightSpaceMatrix = lightProjection * lightView;
+        cascadedShadowMap.Update(view, glm::radians(cameraFov), pixelFrameBuffer.GetAspect(), cameraNearPlane, shadowDistance, directionalLights[0].direction);
+        std::size_t cascadesHash = 0;
+        for (int i = 0; i < cascadedShadowMap.GetCascadeCount(); i++)
+            cascadesHash = ShadowCache::Hash(cascadedShadowMap.GetLightSpaceMatrix(i), cascadesHash);
+
         // render scene from light's point of view
-        depthShader.Use();
-        depthShader.Set<4, 4>("lightSpaceMatrix", lightSpaceMatrix);
+        if (directionalShadowCache.UpdateStatic(cascadesHash))
+        {
+            depthShader.Use();
+            for (int i = 0; i < cascadedShadowMap.GetCascadeCount(); i++)
+            {
+                depthShader.Set<4, 4>("lightSpaceMatrix", cascadedShadowMap.GetLightSpaceMatrix(i));
+                cascadedShadowMap.BindLayer(i, true);
+                renderStaticScene(depthShader);
+            }
+            CascadedShadowMap::Unbind();
+        }
 
-        depthMap.Bind();
-        renderScene(depthShader);
-        depthMap.Unbind();
+        if (directionalShadowCache.UpdateDynamic(dynamicCastersHash))
+        {
+            depthShader.Use();
+            cascadedShadowMap.CopyStaticLayers();
+            for (int i = 0; i < cascadedShadowMap.GetCascadeCount(); i++)
+            {
+                depthShader.Set<4, 4>("lightSpaceMatrix", cascadedShadowMap.GetLightSpaceMatrix(i));
+                cascadedShadowMap.BindLayer(i, false, false);
+                renderDynamicScene(depthShader, playerBones);
+            }
+            CascadedShadowMap::Unbind();
+        }
 
         // 2. render depth cubemap
         // --------------------------------
-        float aspect = static_cast<float>(1024) / static_cast<float>(1024);
-        near_plane = 1.0f;
-        far_plane = 25.0f;
+        float aspect = static_cast<float>(pointShadowMapResolution) / static_cast<float>(pointShadowMapResolution);
+        float near_plane = 1.0f;
+        float far_plane = 25.0f;
         glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), aspect, near_plane, far_plane);
-        std::vector<glm::mat4> shadowTransforms;
-        shadowTransforms.push_back(shadowProj * glm::lookAt(glm::vec3(pointLights[0].position), glm::vec3(pointLights[0].position) + glm::vec3(1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0)));
-        shadowTransforms.push_back(shadowProj * glm::lookAt(glm::vec3(pointLights[0].position), glm::vec3(pointLights[0].position) + glm::vec3(-1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0)));
-        shadowTransforms.push_back(shadowProj * glm::lookAt(glm::vec3(pointLights[0].position), glm::vec3(pointLights[0].position) + glm::vec3(0.0, 1.0, 0.0), glm::vec3(0.0, 0.0, 1.0)));
-        shadowTransforms.push_back(shadowProj * glm::lookAt(glm::vec3(pointLights[0].position), glm::vec3(pointLights[0].position) + glm::vec3(0.0, -1.0, 0.0), glm::vec3(0.0, 0.0, -1.0)));
-        shadowTransforms.push_back(shadowProj * glm::lookAt(glm::vec3(pointLights[0].position), glm::vec3(pointLights[0].position) + glm::vec3(0.0, 0.0, 1.0), glm::vec3(0.0, -1.0, 0.0)));
-        shadowTransforms.push_back(shadowProj * glm::lookAt(glm::vec3(pointLights[0].position), glm::vec3(pointLights[0].position) + glm::vec3(0.0, 0.0, -1.0), glm::vec3(0.0, -1.0, 0.0)));
-
-        depthCubemap.Bind();
-        pointDepthShader.Use();
-        for (unsigned int i = 0; i < 6; ++i)
-            pointDepthShader.Set<4, 4>(std::format("shadowMatrices[{}]", i).c_str(), shadowTransforms[i]);
-        pointDepthShader.Set("far_plane", far_plane);
-        pointDepthShader.Set<3>("lightPos", glm::vec3(pointLights[0].position));
-        renderScene(pointDepthShader);
-        depthCubemap.Unbind();
+        const std::array shadowTransforms = {
+            shadowProj * glm::lookAt(glm::vec3(pointLights[0].position), glm::vec3(pointLights[0].position) + glm::vec3(1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0)),
+            shadowProj * glm::lookAt(glm::vec3(pointLights[0].position), glm::vec3(pointLights[0].position) + glm::vec3(-1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0)),
+            shadowProj * glm::lookAt(glm::vec3(pointLights[0].position), glm::vec3(pointLights[0].position) + glm::vec3(0.0, 1.0, 0.0), glm::vec3(0.0, 0.0, 1.0)),
+            shadowProj * glm::lookAt(glm::vec3(pointLights[0].position), glm::vec3(pointLights[0].position) + glm::vec3(0.0, -1.0, 0.0), glm::vec3(0.0, 0.0, -1.0)),
+            shadowProj * glm::lookAt(glm::vec3(pointLights[0].position), glm::vec3(pointLights[0].position) + glm::vec3(0.0, 0.0, 1.0), glm::vec3(0.0, -1.0, 0.0)),
+            shadowProj * glm::lookAt(glm::vec3(pointLights[0].position), glm::vec3(pointLights[0].position) + glm::vec3(0.0, 0.0, -1.0), glm::vec3(0.0, -1.0, 0.0)),
+        };
+
+        const auto setPointDepthUniforms = [&]() -> void
+        {
+            pointDepthShader.Use();
+            for (int i = 0; i < 6; ++i)
+                pointDepthShader.Set<4, 4>(IndexedUniformName("shadowMatrices", i).c_str(), shadowTransforms[i]);
+            pointDepthShader.Set("far_plane", far_plane);
+            pointDepthShader.Set<3>("lightPos", glm::vec3(pointLights[0].position));
+        };
+
+        if (pointShadowCache.UpdateStatic(ShadowCache::Hash(&pointLights[0].position.x, 4, std::hash<float>{}(far_plane))))
+        {
+            staticDepthCubemap.Bind();
+            setPointDepthUniforms();
+            renderStaticScene(pointDepthShader);
+            staticDepthCubemap.Unbind();
+        }
+
+        if (pointShadowCache.UpdateDynamic(dynamicCastersHash))
+        {
+            depthCubemap.Bind();
+            ShadowCache::CopyDepth(staticDepthCubemap.GetDepthMap(), depthCubemap.GetDepthMap(), GL_TEXTURE_CUBE_MAP,
+                                   pointShadowMapResolution, pointShadowMapResolution, 6);
+            setPointDepthUniforms();
+            renderDynamicScene(pointDepthShader, playerBones);
+            depthCubemap.Unbind();
+        }
+
+        profiler.End();
+        MemoryTracker::SetCurrentTag(MemoryTag::General);
 
         // render scene as normal using the generated depth/shadow map
         // --------------------------------------------------------------
+        // The timings arrive a few frames late, the controller only reacts every few dozen frames anyway
+        if (frameTimer.Poll() && enablePixelate && debugSettings.enableDynamicResolution
+            && dynamicResolution.Update(frameTimer.GetMilliseconds(), debugSettings.targetFrameTime))
+            pixelFbResolution = dynamicResolution.GetWidth();
+
         if (enablePixelate)
         {
             if (pixelFbResolution != lastPixelFbResolution)
@@ -727,73 +1743,120 @@ int main()
 
         window.StartGui();
 
-        mainCamera->Move(deltaTime);
-
         glm::mat4 model(1.0f);
-        view = mainCamera->GetLookAt();
-        projection = glm::perspective(glm::radians(45.0f), pixelFrameBuffer.GetAspect(), 0.1f, 100.0f);
+
+        frameContext.view = view;
+        frameContext.projection = projection;
+        frameContext.cameraPosition = mainCamera->GetPosition();
+        renderQueue.Begin(mainCamera->GetPosition(), cameraFarPlane);
 
         if (enableSkybox)
+            renderQueue.SubmitCustom(RenderPass::Skybox, drawSkybox, &frameContext);
+
+        profiler.Begin("animation");
+        playerAnimator.UpdateAnimation(deltaTime);
+        playerBones = playerAnimator.GetFinalBoneMatrices();
+        for (std::size_t i = 0; i < benchmarkRunners.size(); i++)
         {
-            skybox
-                .BeginRender(skyboxShader)
-                .SetProjection(projection)
-                .SetView(view)
-                .Render();
+            benchmarkRunners[i].UpdateAnimation(deltaTime);
+            benchmarkRunnerBones[i] = benchmarkRunners[i].GetFinalBoneMatrices();
         }
+        profiler.End();
 
-        shader.Use();
-        uniforms.model = shader.GetUniformLocation("model");
-
-        playerAnimator.UpdateAnimation(deltaTime);
+        profiler.Begin("lights");
+        clusteredLights.Begin(projection, cameraNearPlane, cameraFarPlane);
+        for (size_t i = 0; i < pointLights.Size(); ++i)
+            clusteredLights.AddLight(view, pointLights[i], static_cast<std::uint32_t>(i));
+        clusteredLights.Upload();
+        profiler.End();
 
-        shader.Set("pointLightsSize", static_cast<int>(pointLights.Size()));
-        shader.Set("directionalLightsSize", static_cast<int>(directionalLights.Size()));
-        shader.Set<4, 4>("view", view);
-        shader.Set<4, 4>("projection", projection);
-        shader.Set<3>("ambientLightColor", glm::vec3{1.0f, 1.0f, 1.0f});
-        shader.Set<3>("fogColor", glm::vec3(0.0f));
-        shader.Set<4, 4>("lightSpaceMatrix", lightSpaceMatrix);
-        shader.Set("far_plane", far_plane);
-        shader.Set("calculatePointLightShadows", true);
         glActiveTexture(GL_TEXTURE10);
-        glBindTexture(GL_TEXTURE_2D, depthMap.GetDepthMap());
-        shader.Set("shadowMap", 10);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, cascadedShadowMap.GetDepthArray());
         glActiveTexture(GL_TEXTURE11);
         glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubemap.GetDepthMap());
-        shader.Set("depthMap", 11);
 
+        const int variantPcfRadius = enableShaderVariants ? std::clamp(debugSettings.shadowPcfRadius, 0, 2) : -1;
+        if (variantPcfRadius != resolvedPcfRadius || shaderVariants.GetVersion() != resolvedVariantsVersion || shader.ID != baseUniforms[0].program)
+        {
+            const std::array<unsigned int, 2> baseVariants = enableShaderVariants ? getBaseVariants(variantPcfRadius) : std::array<unsigned int, 2>{};
+            renderQueue.SetVariants(shader, baseVariants[0], baseVariants[1]);
+            baseUniforms = {LocateBaseUniforms(shader.ID), LocateBaseUniforms(baseVariants[0]), LocateBaseUniforms(baseVariants[1])};
+            resolvedPcfRadius = variantPcfRadius;
+            resolvedVariantsVersion = shaderVariants.GetVersion();
+        }
+
+        // Uniform values live in each program, the variants drawn this frame get the same ones as the base shader
+        for (const BaseUniforms &uniforms : baseUniforms)
+        {
+            const unsigned int program = uniforms.program;
+            if (program == 0) continue;
+            ShaderVariantCache::SetUniform(program, uniforms.shadowPcfRadius, debugSettings.shadowPcfRadius);
+            ShaderVariantCache::SetUniform(program, uniforms.calculatePointLightShadows, 1);
+            ShaderVariantCache::SetUniform(program, uniforms.clusterNear, clusteredLights.GetNearPlane());
+            ShaderVariantCache::SetUniform(program, uniforms.clusterFar, clusteredLights.GetFarPlane());
+            ShaderVariantCache::SetUniform(program, uniforms.directionalLightsSize, static_cast<int>(directionalLights.Size()));
+            ShaderVariantCache::SetUniform(program, uniforms.view, view);
+            ShaderVariantCache::SetUniform(program, uniforms.projection, projection);
+            ShaderVariantCache::SetUniform(program, uniforms.ambientLightColor, glm::vec3{1.0f, 1.0f, 1.0f});
+            ShaderVariantCache::SetUniform(program, uniforms.fogColor, glm::vec3(0.0f));
+            for (int i = 0; i < cascadedShadowMap.GetCascadeCount(); i++)
+            {
+                const auto element = [i](const GLint location) { return location < 0 ? -1 : location + i; };
+                ShaderVariantCache::SetUniform(program, element(uniforms.lightSpaceMatrices), cascadedShadowMap.GetLightSpaceMatrix(i));
+                ShaderVariantCache::SetUniform(program, element(uniforms.cascadeFarPlanes), cascadedShadowMap.GetCascadeFarPlane(i));
+                ShaderVariantCache::SetUniform(program, element(uniforms.cascadeTexelDepths), cascadedShadowMap.GetCascadeTexelDepth(i));
+            }
+            ShaderVariantCache::SetUniform(program, uniforms.cascadeCount, cascadedShadowMap.GetCascadeCount());
+            ShaderVariantCache::SetUniform(program, uniforms.farPlane, far_plane);
+            ShaderVariantCache::SetUniform(program, uniforms.shadowMap, 10);
+            ShaderVariantCache::SetUniform(program, uniforms.depthMap, 11);
+        }
+
+        meshSubmitSystem->SetCamera(mainCamera->GetPosition(), projection);
+        meshSubmitSystem->SetLodEnabled(enableLod);
+        particleSystem->SetCamera(view, projection, mainCamera->GetPosition());
+        // Particles scroll with the road while running
+        particleSystem->SetWorldVelocity(gameScene == INGAME && runnerSystem->IsEnabled() ? glm::vec3(-debugSettings.pathVelocity, 0.0f, 0.0f) : glm::vec3(0.0f));
+        // Spawning and destroying entities is most of what the systems and the game logic allocate
+        profiler.Begin("systems");
+        MemoryTracker::SetCurrentTag(MemoryTag::Registry);
+        entityCommands.ResetStats();
+        // Only a run has a player, the systems get its handle instead of searching for it
+        const ECS::Entity runPlayer = gameScene == INGAME || gameScene == GAMEOVER ? player : RunnerSystem::NoPlayer;
+        runnerSystem->SetPlayer(runPlayer);
+        coinSystem->SetPlayer(runPlayer);
+        // The game over pose is set by the scene logic after the update, the cache picks it up here on the next frame
+        if (gameScene == GAMEOVER)
+            registry.GetComponent<ECS::Components::Transform>(playerMesh).scale = glm::vec3(0.150f);
         systemManager.UpdateAll(registry, deltaTime);
+        entityCommands.Playback(registry);
+        profiler.End();
 
+        profiler.Begin("scene");
+        // The HUD of the scene that was submitted is drawn after the queue, even if the logic switches scene
+        const GameScene drawnScene = gameScene;
         switch (gameScene)
         {
         case MAINMENU:
         {
-            renderScene(shader);
-
-            fontBearDays.SetScale(1.2f, static_cast<float>(window.GetWidth()), static_cast<float>(window.GetHeight()))
-                .SetColor(currentOption == START ? glm::vec4(1.0f) : glm::vec4(0.8f, 0.8f, 0.8f, 1.0f))
-                .Render(0.3f, 0.2f, "Start");
-
-            fontBearDays
-                .SetColor(currentOption == EXIT ? glm::vec4(1.0f) : glm::vec4(0.8f, 0.8f, 0.8f, 1.0f))
-                .Render(0.3f, -0.2f, "Exit");
-
-            fontBearDays.SetScale(1.8f, static_cast<float>(window.GetWidth()), static_cast<float>(window.GetHeight()))
-                .SetColor(glm::vec4(1.0f))
-                .Render(-0.9f, -0.7f, "City Escape");
+            submitMenuScene(renderQueue, playerBones);
 
-            fontBearDays.SetScale(0.60f, static_cast<float>(window.GetWidth()), static_cast<float>(window.GetHeight()))
-                .SetColor(glm::vec4(1.0f))
-                .Render(-0.9f, -0.9f, "An Advanced Computer Graphics Project");
-
-            if (keyboard.GetKeyPress(GLFW_KEY_ENTER) || joystick.GetButtonPress(GLFW_GAMEPAD_BUTTON_A))
+            if (actions.WasPressed(Action::Confirm))
             {
                 switch (menuOptions[currentOption])
                 {
                 case START:
-                    registry.Reset();
-                    LoadInGameEntities();
+                    particleSystem->Clear();
+                    rewindBuffer.Clear();
+                    if (runStart.entities.IsCaptured())
+                        RestoreGame(runStart, false);
+                    else
+                    {
+                        // Also resets the game variables of the previous run
+                        RestoreGame(initialGame, false);
+                        LoadInGameEntities();
+                        CaptureGame(runStart);
+                    }
                     mainGameStarted = true;
                     runnerSystem->SetEnabled(true);
                     mainCamera = &gameCamera;
@@ -812,23 +1875,12 @@ int main()
                 }
             }
 
-            if (!menuUp.event && (keyboard.GetKeyPress(GLFW_KEY_UP) || joystick.GetButtonPress(GLFW_GAMEPAD_BUTTON_DPAD_UP)))
-                menuUp.event = true;
-
-            if (!menuDown.event && (keyboard.GetKeyPress(GLFW_KEY_DOWN) || joystick.GetButtonPress(GLFW_GAMEPAD_BUTTON_DPAD_DOWN)))
-                menuDown.event = true;
-
-            if (menuUp.event && (!keyboard.GetKeyPress(GLFW_KEY_UP) && !joystick.GetButtonPress(GLFW_GAMEPAD_BUTTON_DPAD_UP)))
-            {
+            // Every press counts, even several between two frames
+            for (int i = 0; i < actions.GetPressCount(Action::MenuUp); i++)
                 currentOption = (currentOption == 0) ? menuOptions.size() - 1 : currentOption - 1;
-                menuUp.event = false;
-            }
 
-            if (menuDown.event && (!keyboard.GetKeyPress(GLFW_KEY_DOWN) && !joystick.GetButtonPress(GLFW_GAMEPAD_BUTTON_DPAD_DOWN)))
-            {
+            for (int i = 0; i < actions.GetPressCount(Action::MenuDown); i++)
                 currentOption = (currentOption == menuOptions.size() - 1) ? 0 : currentOption + 1;
-                menuDown.event = false;
-            }
 
             break;
         }
@@ -839,21 +1891,23 @@ int main()
             cameraTransform.translation = mainCamera->GetPosition();
             // cameraTransform.rotation = mainCamera->GetRotation(); // Assuming Camera has GetRotation
 
-            std::vector<glm::mat4> finalBones;
             // region Game Logic
             metersRunned += debugSettings.pathVelocity * deltaTime;
             // * ================================================================= *
             // * Path Generation                                                   *
             // * ================================================================= *
             // 1.1 Path movement update ================================================================================
-            for (ECS::Entity pathEntity : registry.View<PathComponent, ECS::Components::Transform>())
+            for (ECS::Entity pathEntity : GameQuery<PathComponent, ECS::Components::Transform>::View(registry))
             {
                 auto &transform = registry.GetComponent<ECS::Components::Transform>(pathEntity);
                 transform.translation.x = transform.translation.x - debugSettings.pathVelocity * deltaTime;
 
                 // Remove out of view paths
                 if (transform.translation.x <= -5.0f)
-                    registry.DestroyEntity(pathEntity);
+                {
+                    entityCommands.Destroy(pathEntity);
+                    gameStats->Add(GameStat::PathsCulled);
+                }
             }
 
             // 1.2 Create required new paths ===========================================================================
@@ -867,7 +1921,9 @@ int main()
                 })
                     .AddComponent(e, PathComponent{})
                     .AddComponent(e, ECS::Components::MeshRenderer{.model = &pathChunk01, .shader = &shader});
+                entitySignatures.Refresh(registry, e);
                 lastPath = e;
+                gameStats->Add(GameStat::PathsSpawned);
                 pathsGenerated = (pathsGenerated + 1) % generatorSpaceInterval;
                 obstaclesCanSpawn = true;
             }
@@ -876,33 +1932,42 @@ int main()
             // * Obstacles and Coins generation                                    *
             // * ================================================================= *
             // 2.1 Update obstacles ====================================================================================
-            for (const ECS::Entity obstacle : registry.View<ObstacleComponent, ECS::Components::Transform>())
+            for (const ECS::Entity obstacle : GameQuery<ObstacleComponent, ECS::Components::Transform>::View(registry))
             {
                 auto &transform = registry.GetComponent<ECS::Components::Transform>(obstacle);
                 transform.translation.x = transform.translation.x - debugSettings.pathVelocity * deltaTime;
 
                 if (transform.translation.x <= -5.0f)
-                    registry.DestroyEntity(obstacle);
+                {
+                    entityCommands.Destroy(obstacle);
+                    gameStats->Add(GameStat::ObstaclesCulled);
+                }
             }
 
             // 2.2 Update coins ========================================================================================
-            for (const ECS::Entity coin : registry.View<CoinComponent, ECS::Components::Transform>())
+            for (const ECS::Entity coin : GameQuery<CoinComponent, ECS::Components::Transform>::View(registry))
             {
                 auto &transform = registry.GetComponent<ECS::Components::Transform>(coin);
                 transform.translation.x = transform.translation.x - debugSettings.pathVelocity * deltaTime;
 
                 if (transform.translation.x <= -5.0f)
-                    registry.DestroyEntity(coin);
+                {
+                    entityCommands.Destroy(coin);
+                    gameStats->Add(GameStat::CoinsCulled);
+                }
             }
 
             // 2.2.1 Update buildings ================================================================================
-            for (const ECS::Entity building : registry.View<BuildingComponent, ECS::Components::Transform>())
+            for (const ECS::Entity building : GameQuery<BuildingComponent, ECS::Components::Transform>::View(registry))
             {
                 auto &transform = registry.GetComponent<ECS::Components::Transform>(building);
                 transform.translation.x = transform.translation.x - debugSettings.pathVelocity * deltaTime;
 
                 if (transform.translation.x <= -25.0f)
-                    registry.DestroyEntity(building);
+                {
+                    entityCommands.Destroy(building);
+                    gameStats->Add(GameStat::BuildingsCulled);
+                }
             }
 
             lastBuildingXLeft -= debugSettings.pathVelocity * deltaTime;
@@ -916,7 +1981,8 @@ int main()
                 const int genIdx = obstaclePatternGenerator(generator);
                 const auto pattern = ObstaclePatterns[genIdx];
 
-                std::vector<size_t> cleanLanes;
+                FrameVector<size_t> cleanLanes{ArenaAllocator<size_t>(frameArena)};
+                cleanLanes.reserve(pattern.size());
                 for (size_t i = 0; i < pattern.size(); i++)
                 {
                     if (pattern[i] == CLEAN)
@@ -927,21 +1993,23 @@ int main()
 
                     constexpr float laneWidth = 2.0f;
                     const float obstaclePos = (static_cast<float>(i) * laneWidth) - laneWidth;
-                    ECS::Entity obstacle = registry.CreateEntity();
+                    const ECS::Entity obstacle = entityCommands.Create();
                     std::uniform_int_distribution<size_t> obstacleTypeGenerator(0, obstacleGenComponents.size() - 1);
                     auto it = obstacleGenComponents.begin();
                     std::advance(it, obstacleTypeGenerator(generator));
                     // ReSharper disable once CppUseStructuredBinding
                     ObstacleInfo randomObstacle = it->second;
 
-                    registry.AddComponent(obstacle, ECS::Components::Transform{
-                                                        .translation = {lastPathTransform.translation.x, randomObstacle.transform.translation.y, obstaclePos},
-                                                        .rotation = randomObstacle.transform.rotation,
-                                                        .scale = randomObstacle.transform.scale
+                    entityCommands.Add(obstacle, ECS::Components::Transform{
+                                                     .translation = {lastPathTransform.translation.x, randomObstacle.transform.translation.y, obstaclePos},
+                                                     .rotation = randomObstacle.transform.rotation,
+                                                     .scale = randomObstacle.transform.scale
                     })
-                        .AddComponent(obstacle, ECS::Components::AABBCollider{.min = randomObstacle.collider.min, .max = randomObstacle.collider.max})
-                        .AddComponent(obstacle, randomObstacle.meshRenderer)
-                        .AddComponent(obstacle, ObstacleComponent{});
+                        .Add(obstacle, ECS::Components::AABBCollider{.min = randomObstacle.collider.min, .max = randomObstacle.collider.max})
+                        .Add(obstacle, randomObstacle.meshRenderer)
+                        .Add(obstacle, randomObstacle.lod)
+                        .Add(obstacle, ObstacleComponent{});
+                    gameStats->Add(GameStat::ObstaclesSpawned);
                 }
 
                 // 2.4 Create new coins ================================================================================
@@ -957,16 +2025,17 @@ int main()
 
                     for (int i = 0; i < coinsInRow; i++)
                     {
-                        ECS::Entity coin = registry.CreateEntity();
-                        registry
-                            .AddComponent(coin, ECS::Components::Transform{
-                                                    .translation = {lastPathTransform.translation.x + (static_cast<float>(i) * 2.0f), 1.0f, coinLanePos},
-                                                    .scale = glm::vec3(0.8f)
+                        const ECS::Entity coin = entityCommands.Create();
+                        entityCommands
+                            .Add(coin, ECS::Components::Transform{
+                                           .translation = {lastPathTransform.translation.x + (static_cast<float>(i) * 2.0f), 1.0f, coinLanePos},
+                                           .scale = glm::vec3(0.8f)
                         })
-                            .AddComponent(coin, ECS::Components::MeshRenderer{.model = &coinModel, .shader = &shader})
-                            .AddComponent(coin, ECS::Components::AABBCollider{.min = glm::vec3(-0.25f), .max = glm::vec3(0.25f)})
-                            .AddComponent(coin, CoinComponent{5});
+                            .Add(coin, ECS::Components::MeshRenderer{.model = &coinModel, .shader = &shader})
+                            .Add(coin, ECS::Components::AABBCollider{.min = glm::vec3(-0.25f), .max = glm::vec3(0.25f)})
+                            .Add(coin, CoinComponent{5});
                     }
+                    gameStats->Add(GameStat::CoinsSpawned, static_cast<std::uint64_t>(coinsInRow));
                 }
 
                 // 2.5 Building generation ================================================================================
@@ -982,17 +2051,19 @@ int main()
                     std::advance(it, buildingTypeGenerator(generator));
                     const BuildingInfo randomBuilding = it->second;
 
-                    ECS::Entity building = registry.CreateEntity();
+                    const ECS::Entity building = entityCommands.Create();
 
                     const glm::quat rotation = glm::quat_cast(glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), {0, 1, 0}));
 
-                    registry.AddComponent(building, ECS::Components::Transform{
-                                                        .translation = {generationPointX, 0.0f, buildingSideOffset},
-                                                        .rotation = rotation,
-                                                        .scale = randomBuilding.transform.scale
+                    entityCommands.Add(building, ECS::Components::Transform{
+                                                     .translation = {generationPointX, 0.0f, buildingSideOffset},
+                                                     .rotation = rotation,
+                                                     .scale = randomBuilding.transform.scale
                     })
-                        .AddComponent(building, randomBuilding.meshRenderer)
-                        .AddComponent(building, BuildingComponent{});
+                        .Add(building, randomBuilding.meshRenderer)
+                        .Add(building, randomBuilding.lod)
+                        .Add(building, BuildingComponent{});
+                    gameStats->Add(GameStat::BuildingsSpawned);
 
                     lastBuildingXLeft = generationPointX + buildingSeparation;
                 }
@@ -1004,15 +2075,17 @@ int main()
                     std::advance(it, buildingTypeGenerator(generator));
                     const BuildingInfo randomBuilding = it->second;
 
-                    ECS::Entity building = registry.CreateEntity();
+                    const ECS::Entity building = entityCommands.Create();
 
-                    registry.AddComponent(building, ECS::Components::Transform{
-                                                        .translation = {generationPointX, 0.0f, -buildingSideOffset},
-                                                        .rotation = randomBuilding.transform.rotation,
-                                                        .scale = randomBuilding.transform.scale
+                    entityCommands.Add(building, ECS::Components::Transform{
+                                                     .translation = {generationPointX, 0.0f, -buildingSideOffset},
+                                                     .rotation = randomBuilding.transform.rotation,
+                                                     .scale = randomBuilding.transform.scale
                     })
-                        .AddComponent(building, randomBuilding.meshRenderer)
-                        .AddComponent(building, BuildingComponent{});
+                        .Add(building, randomBuilding.meshRenderer)
+                        .Add(building, randomBuilding.lod)
+                        .Add(building, BuildingComponent{});
+                    gameStats->Add(GameStat::BuildingsSpawned);
 
                     lastBuildingXRight = generationPointX + buildingSeparation;
                 }
@@ -1027,10 +2100,15 @@ int main()
             {
                 for (auto &collidingEntity : playerCollider.collidingEntities)
                 {
-                    if (registry.HasComponent<ObstacleComponent>(collidingEntity))
+                    if (GameQuery<ObstacleComponent>::Matches(entitySignatures, collidingEntity))
                     {
                         playerComponent.obstacleHits++;
-                        registry.DestroyEntity(collidingEntity);
+                        const ECS::Entity debris = entityCommands.Create();
+                        entityCommands
+                            .Add(debris, ECS::Components::Transform{.translation = registry.GetComponent<ECS::Components::Transform>(collidingEntity).translation})
+                            .Add(debris, ParticleEmitterComponent{.effect = ParticleEffect::ObstacleDebris, .burst = 40});
+                        entityCommands.Destroy(collidingEntity);
+                        gameStats->Add(GameStat::ObstaclesHit);
                     }
                 }
             }
@@ -1046,148 +2124,134 @@ int main()
                 }
             }
 
-            // playerAnimator.UpdateAnimation(deltaTime);
-            finalBones = playerAnimator.GetFinalBoneMatrices();
-
-            auto playerTransform = registry.GetComponent<ECS::Components::Transform>(player);
-            model = glm::translate(glm::mat4(1.0f), playerTransform.translation) * glm::mat4_cast(playerTransform.rotation) * glm::scale(glm::mat4(1.0f), playerTransform.scale);
-            model = glm::translate(model, {0.0f, -0.80f, 0.0f});
-            model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::scale(model, glm::vec3(0.20f));
-            shader.Set<4, 4>(uniforms.model, model);
-            for (unsigned int i = 0; i < finalBones.size(); i++)
-                shader.Set<4, 4>(std::format("bones[{}]", i).c_str(), finalBones[i]);
-            lowPolyManModel.Render(shader);
-
-            for (unsigned int i = 0; i < MAX_BONES; i++)
-                shader.Set<4, 4>(std::format("bones[{}]", i).c_str(), glm::mat4(1.0f));
+            // The snapshots need the spawns and destroys of this frame
+            entityCommands.Playback(registry);
+            if (gameScene == INGAME)
+                rewindBuffer.Update(deltaTime);
 
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            renderQueue.Submit(RenderPass::Opaque, shader, lowPolyManModel, transformCache->GetWorldMatrix(playerMesh), playerBones.data(),
+                               static_cast<std::uint32_t>(playerBones.size()));
 
             if (enableGrid)
-            {
-                gridShader.Use();
-                gridShader.Set<4, 4>("uVP", projection * view);
-                gridShader.Set<3>("cameraPosition", mainCamera->GetPosition());
-                plane.Render();
-                shader.Use();
-            }
+                renderQueue.SubmitCustom(RenderPass::Transparent, drawGrid, &frameContext);
 
             if (debugSettings.showHitboxes)
+                renderQueue.SubmitCustom(RenderPass::Debug, drawHitboxes, &frameContext);
+            break;
+        }
+        case GAMEOVER:
+        {
+            renderQueue.Submit(RenderPass::Opaque, shader, lowPolyManModel, transformCache->GetWorldMatrix(playerMesh), playerBones.data(),
+                               static_cast<std::uint32_t>(playerBones.size()));
+
+            if (actions.WasPressed(Action::Restart))
             {
-                glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-                debugShader.Use();
-                const GLint debugProjection = debugShader.GetUniformLocation("projection");
-                const GLint debugView = debugShader.GetUniformLocation("view");
-                const GLint debugModel = debugShader.GetUniformLocation("model");
-                const GLint debugColor = debugShader.GetUniformLocation("color");
-                debugShader.Set<3>(debugColor, glm::vec3(1.0f, 1.0f, 0.0f));
-                debugShader.Set<4, 4>(debugProjection, projection);
-                debugShader.Set<4, 4>(debugView, view);
-
-                // AABB Debug draw
-                for (const ECS::Entity colliderEntity : registry.View<ECS::Components::AABBCollider, ECS::Components::Transform>())
+                gameScene = MAINMENU;
+                mainCamera = &menuCamera;
+                entityCommands.Clear();
+                registry.Reset();
+                entitySignatures.Rebuild(registry);
+                gameStats->Reset();
+                particleSystem->Clear();
+                playerAnimation = lowPolyManModel.GetAnimation(2);
+                if (playerAnimation)
                 {
-                    const auto &transform = registry.GetComponent<ECS::Components::Transform>(colliderEntity);
-                    const auto &collider = registry.GetComponent<ECS::Components::AABBCollider>(colliderEntity);
-                    const auto worldCollider = collider.GetWorldAABB(transform);
-
-                    // Only to differentiate floor&player grounding from other colliders
-                    if ((registry.HasComponent<RunnerComponent>(colliderEntity)
-                         && collider.collidingEntities.size() == 1
-                         && std::ranges::find(collider.collidingEntities, floorEntity) != collider.collidingEntities.end())
-                        || (registry.HasComponent<FloorComponent>(colliderEntity)
-                            && std::ranges::find(collider.collidingEntities, player) != collider.collidingEntities.end()))
-                        debugShader.Set<3>(debugColor, glm::vec3(0.0f, 1.0f, 1.0f));
-                    else
-                        debugShader.Set<3>(debugColor, collider.isColliding
-                                                           ? glm::vec3(1.0f, 0.0f, 0.0f)
-                                                           : glm::vec3(1.0f, 1.0f, 0.0f));
-
-                    auto collidersModel = glm::mat4(1.0f);
-                    collidersModel = glm::translate(collidersModel, worldCollider.min + (worldCollider.max - worldCollider.min) * 0.5f);
-                    collidersModel = glm::scale(collidersModel, worldCollider.max - worldCollider.min);
-                    debugShader.Set<4, 4>(debugModel, collidersModel);
-
-                    cube.Render();
+                    playerAnimator.PlayAnimation(playerAnimation);
                 }
-
-                // OBB Debug draw
-                for (const ECS::Entity obbEntity : registry.View<ECS::Components::OBBCollider, ECS::Components::Transform>())
+            }
+            else if (const GameSnapshot *rewind = rewindBuffer.Oldest(); rewind && actions.WasPressed(Action::Continue))
+            {
+                RestoreGame(*rewind, true);
+                rewindBuffer.Clear();
+                particleSystem->Clear();
+                runnerSystem->SetEnabled(true);
+                gameScene = INGAME;
+                playerAnimation = lowPolyManModel.GetAnimation(7);
+                if (playerAnimation)
                 {
-                    const auto &transform = registry.GetComponent<ECS::Components::Transform>(obbEntity);
-                    const auto &collider = registry.GetComponent<ECS::Components::OBBCollider>(obbEntity);
-                    const auto worldOBB = collider.GetWorldOBB(transform);
+                    playerAnimator.PlayAnimation(playerAnimation);
+                }
+            }
 
-                    debugShader.Set<3>(debugColor, collider.isColliding ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(1.0f, 1.0f, 0.0f));
+            break;
+        }
+        case BENCHMARK:
+        {
+            for (std::size_t i = 0; i < benchmarkRunnerBones.size(); i++)
+            {
+                const glm::vec3 position = {2.0f + 4.0f * static_cast<float>(i / 3), 1.0f, static_cast<float>(i % 3) * 2.0f - 2.0f};
+                model = glm::translate(glm::mat4(1.0f), position);
+                model = glm::translate(model, {0.0f, -0.80f, 0.0f});
+                model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+                model = glm::scale(model, glm::vec3(0.20f));
+                renderQueue.Submit(RenderPass::Opaque, shader, lowPolyManModel, model, benchmarkRunnerBones[i].data(),
+                                   static_cast<std::uint32_t>(benchmarkRunnerBones[i].size()));
+            }
+            break;
+        }
+            // endregion Game Logic
+        default:;
+        }
+        entityCommands.Playback(registry);
+        profiler.End();
+
+        profiler.Begin("render");
+        MemoryTracker::SetCurrentTag(MemoryTag::Rendering);
+        renderQueue.Execute();
+        profiler.End();
+        MemoryTracker::SetCurrentTag(MemoryTag::General);
+
+        profiler.Begin("post");
+        // region HUD
+        switch (drawnScene)
+        {
+        case MAINMENU:
+            fontBearDays.SetScale(1.2f, static_cast<float>(window.GetWidth()), static_cast<float>(window.GetHeight()))
+                .SetColor(currentOption == START ? glm::vec4(1.0f) : glm::vec4(0.8f, 0.8f, 0.8f, 1.0f))
+                .Render(0.3f, 0.2f, "Start");
 
-                    auto collidersModel = glm::mat4(1.0f);
-                    collidersModel = glm::translate(collidersModel, worldOBB.center);
-                    collidersModel *= glm::mat4_cast(worldOBB.rotation);
-                    collidersModel = glm::scale(collidersModel, worldOBB.halfExtents * 2.0f);
-                    debugShader.Set<4, 4>(debugModel, collidersModel);
+            fontBearDays
+                .SetColor(currentOption == EXIT ? glm::vec4(1.0f) : glm::vec4(0.8f, 0.8f, 0.8f, 1.0f))
+                .Render(0.3f, -0.2f, "Exit");
 
-                    cube.Render();
-                }
-                glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-            }
-            glDisable(GL_BLEND);
+            fontBearDays.SetScale(1.8f, static_cast<float>(window.GetWidth()), static_cast<float>(window.GetHeight()))
+                .SetColor(glm::vec4(1.0f))
+                .Render(-0.9f, -0.7f, "City Escape");
 
+            fontBearDays.SetScale(0.60f, static_cast<float>(window.GetWidth()), static_cast<float>(window.GetHeight()))
+                .SetColor(glm::vec4(1.0f))
+                .Render(-0.9f, -0.9f, "An Advanced Computer Graphics Project");
+            break;
+        case INGAME:
+        {
+            const auto &playerComponent = registry.GetComponent<RunnerComponent>(player);
             fontBearDays.SetScale(0.75f, static_cast<float>(window.GetWidth()), static_cast<float>(window.GetHeight()))
                 .SetColor({1.0f, 0.0f, 0.0f, 0.5f})
-                .Render(-0.95f, 0.70f, std::format("DISTANCE: {:.0f}", metersRunned));
+                .Render(-0.95f, 0.70f, FormatInto(hudText, "DISTANCE: {:.0f}", metersRunned));
 
             fontBearDays.SetScale(0.75f, static_cast<float>(window.GetWidth()), static_cast<float>(window.GetHeight()))
                 .SetColor({1.0f, 1.0f, 0.0f, 0.5f})
-                .Render(-0.95f, 0.85f, std::format("SCORE: {}", playerComponent.score));
+                .Render(-0.95f, 0.85f, FormatInto(hudText, "SCORE: {}", playerComponent.score));
 
             fontBearDays.SetScale(0.75f, static_cast<float>(window.GetWidth()), static_cast<float>(window.GetHeight()))
                 .SetColor({1.0f, 1.0f, 1.0f, 0.5f})
-                .Render(0.75f, 0.85f, std::format("Lives: {}", maxLives - playerComponent.obstacleHits));
+                .Render(0.75f, 0.85f, FormatInto(hudText, "Lives: {}", maxLives - playerComponent.obstacleHits));
             break;
         }
         case GAMEOVER:
-        {
-            auto finalBones = playerAnimator.GetFinalBoneMatrices();
-
-            auto playerTransform = registry.GetComponent<ECS::Components::Transform>(player);
-            model = glm::translate(glm::mat4(1.0f), playerTransform.translation) * glm::mat4_cast(playerTransform.rotation) * glm::scale(glm::mat4(1.0f), playerTransform.scale);
-            model = glm::translate(model, {0.0f, -0.80f, 0.0f});
-            model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::scale(model, glm::vec3(0.150f));
-            shader.Set<4, 4>(uniforms.model, model);
-            for (unsigned int i = 0; i < finalBones.size(); i++)
-                shader.Set<4, 4>(std::format("bones[{}]", i).c_str(), finalBones[i]);
-            lowPolyManModel.Render(shader);
-
-            for (unsigned int i = 0; i < MAX_BONES; i++)
-                shader.Set<4, 4>(std::format("bones[{}]", i).c_str(), glm::mat4(1.0f));
-
             fontBearDays.SetScale(1.8f, static_cast<float>(window.GetWidth()), static_cast<float>(window.GetHeight()))
                 .SetColor(glm::vec4(1.0f, 0.0f, 0.0f, 1.0f))
                 .Render(-0.5f, 0.0f, "GAME OVER");
             fontBearDays.SetScale(0.65f, static_cast<float>(window.GetWidth()), static_cast<float>(window.GetHeight()))
                 .SetColor(glm::vec4(1.0f, 0.0f, 0.0f, 1.0f))
                 .Render(-0.3f, -0.15f, "Press 'C' to return");
-
-            if (keyboard.GetKeyPress(GLFW_KEY_C) || joystick.GetButtonPress(GLFW_GAMEPAD_BUTTON_A))
-            {
-                gameScene = MAINMENU;
-                mainCamera = &menuCamera;
-                registry.Reset();
-                playerAnimation = lowPolyManModel.GetAnimation(2);
-                if (playerAnimation)
-                {
-                    playerAnimator.PlayAnimation(playerAnimation);
-                }
-            }
-
+            if (rewindBuffer.Oldest())
+                fontBearDays.Render(-0.3f, -0.25f, "Press 'R' to continue");
+            fontBearDays.Render(-0.3f, -0.35f, FormatInto(hudText, "Coins: {}", gameStats->Get(GameStat::CoinsCollected)));
             break;
-        }
-            // endregion Game Logic
         default:;
         }
+        // endregion HUD
 
         if (enablePixelate)
         {
@@ -1198,9 +2262,15 @@ int main()
 
         fontArial.SetColor(glm::vec4(1.0f))
             .Render(0.75f, -0.95f, "PreAlpha 1.0.0");
+        profiler.End();
 
-        keyboard.HandleKeyLoop();
+        // The finished frame without the debug GUI
+        profiler.Begin("capture");
+        frameCapture.Capture(window.GetWidth(), window.GetHeight());
+        profiler.End();
 
+        profiler.Begin("gui");
+        MemoryTracker::SetCurrentTag(MemoryTag::Gui);
         // region gui
         if (showDebugGui)
         {
@@ -1229,6 +2299,13 @@ int main()
                         static_cast<double>(playerTransform.translation.y),
                         static_cast<double>(playerTransform.translation.z));
             ImGui::Text("Meters runned: %.2f", static_cast<double>(metersRunned));
+            ImGui::Text("Rewind snapshots: %zu (%zu entities at start)", rewindBuffer.count, runStart.entities.GetEntityCount());
+            ImGui::SeparatorText("Run stats");
+            for (int i = 0; i < static_cast<int>(GameStat::Count); i++)
+            {
+                const auto stat = static_cast<GameStat>(i);
+                ImGui::Text("%s: %llu", GameStats::GetStatName(stat), static_cast<unsigned long long>(gameStats->Get(stat)));
+            }
             ImGui::End();
 
             ImGui::Begin("Engine Info and Settings");
@@ -1236,11 +2313,10 @@ int main()
             ImGui::Text("Delta time = %f", static_cast<double>(deltaTime));
             ImGui::Text("FPS = %f", static_cast<double>(fps));
             ImGui::Text("Paths generated: %d", pathsGenerated);
-#ifdef WIN32
-            ImGui::Text("Entities in scene: %zu", registry.GetEntityCount());
-#else
-            ImGui::Text("Entities in scene: %lu", registry.GetEntityCount());
-#endif
+            const GamePopulation population = gameStats->GetPopulation();
+            ImGui::Text("In scene: %llu paths, %llu obstacles, %llu coins, %llu buildings", static_cast<unsigned long long>(population.paths),
+                        static_cast<unsigned long long>(population.obstacles), static_cast<unsigned long long>(population.coins),
+                        static_cast<unsigned long long>(population.buildings));
 
             if (ImGui::Checkbox("Vsync", &debugSettings.enableVsync))
                 window.EnableVsync(debugSettings.enableVsync);
@@ -1248,20 +2324,136 @@ int main()
             ImGui::Checkbox("Grid", &enableGrid);
             ImGui::Checkbox("Skybox", &enableSkybox);
             ImGui::Checkbox("Show Hitboxes", &debugSettings.showHitboxes);
+            ImGui::Text("Debug lines: %zu", debugDraw.GetLineCount());
+            ImGui::Text("Particles: %zu", particleSystem->GetParticleCount());
+            const auto &transformStats = transformCache->GetStats();
+            ImGui::Text("Transforms updated: %zu / %zu (%.3f ms)", transformStats.updated, transformStats.entities, static_cast<double>(transformStats.milliseconds));
+            const EntityCommandStats &commandStats = entityCommands.GetStats();
+            ImGui::Text("Entity commands: %zu (%zu created, %zu destroyed, %zu skipped)", commandStats.commands, commandStats.created, commandStats.destroyed,
+                        commandStats.skipped);
+
+            ImGui::Text("Heap allocations: %llu last frame", static_cast<unsigned long long>(frameAllocations));
+            ImGui::Text("Frame arena: %zu / %zu KB (%zu overflows)", frameArena.GetLastFrameBytes() / 1024, frameArena.GetCapacity() / 1024,
+                        frameArena.GetOverflowCount());
+
+            ImGui::SeparatorText("Memory");
+            if constexpr (MemoryTracker::Enabled)
+            {
+                for (int i = 0; i < static_cast<int>(MemoryTag::Count); i++)
+                {
+                    const auto tag = static_cast<MemoryTag>(i);
+                    const MemoryTagStats memory = MemoryTracker::GetStats(tag);
+                    ImGui::Text("%s: %.2f MB (peak %.2f MB), %llu allocations last frame%s", MemoryTracker::GetTagName(tag),
+                                static_cast<double>(memory.liveBytes) / (1024.0 * 1024.0), static_cast<double>(memory.peakBytes) / (1024.0 * 1024.0),
+                                static_cast<unsigned long long>(memory.frameAllocations), memory.budget != 0 && memory.liveBytes > memory.budget ? ", OVER BUDGET" : "");
+                }
+            }
+            else
+                ImGui::Text("Build with ENABLE_MEMORY_TRACKING to see the memory per subsystem");
+
+            ImGui::SeparatorText("Shadows");
+            ImGui::Checkbox("Cache shadow maps", &enableShadowCache);
+            ImGui::SliderInt("PCF radius", &debugSettings.shadowPcfRadius, 0, 2);
+            ImGui::Text("Shadow updates skipped: %d / 4", directionalShadowCache.GetSkippedUpdates() + pointShadowCache.GetSkippedUpdates());
+
+            ImGui::SeparatorText("Render queue");
+            const auto &queueStats = renderQueue.GetStats();
+            ImGui::Text("Draw commands: %u", queueStats.commands);
+            ImGui::Text("Shader binds: %u (%u redundant skipped)", queueStats.shaderBinds, queueStats.redundantBindsSkipped);
+            ImGui::Text("Model changes: %u", queueStats.modelChanges);
+            ImGui::Text("Variant draws: %u", queueStats.variantDraws);
+            ImGui::Checkbox("Mesh LODs", &enableLod);
+            const auto &lodStats = meshSubmitSystem->GetLodStats();
+            ImGui::Text("LOD triangles: %zu submitted / %zu at full detail", lodStats.submittedTriangles, lodStats.fullDetailTriangles);
+
+            ImGui::SeparatorText("Frame sections");
+            const auto &sectionNames = profiler.GetNames();
+            const auto &sectionTimes = profiler.GetLastFrame();
+            for (std::size_t i = 0; i < sectionNames.size(); i++)
+                ImGui::Text("%s: %.3f ms", sectionNames[i].c_str(), static_cast<double>(sectionTimes[i]));
 
             ImGui::SeparatorText("Pixelate effect settings");
 
             ImGui::Checkbox("Pixelate framebuffer", &enablePixelate);
-            ImGui::SliderInt("Resolution (width)", &pixelFbResolution, 64, 2048);
+            if (ImGui::SliderInt("Resolution (width)", &pixelFbResolution, 64, 2048))
+                dynamicResolution.SetWidth(pixelFbResolution);
+            ImGui::Checkbox("Dynamic resolution", &debugSettings.enableDynamicResolution);
+            ImGui::DragFloat("Target GPU frame time (ms)", &debugSettings.targetFrameTime, 0.1f, 1.0f, 100.0f);
+            bool boundsChanged = ImGui::DragInt("Min width", &debugSettings.dynamicResolutionMin, 8.0f, 64, 2048);
+            boundsChanged |= ImGui::DragInt("Max width", &debugSettings.dynamicResolutionMax, 8.0f, 64, 2048);
+            if (boundsChanged)
+                dynamicResolution.SetBounds(debugSettings.dynamicResolutionMin, debugSettings.dynamicResolutionMax);
+            ImGui::Text("GPU frame time: %.2f ms", static_cast<double>(frameTimer.GetMilliseconds()));
+
+            ImGui::SeparatorText("Frame capture");
+            const FrameCaptureStats captureStats = frameCapture.GetStats();
+            ImGui::Text("Main thread: %.3f ms", static_cast<double>(captureStats.mainThreadMilliseconds));
+            ImGui::Text("Frames written: %u (%u dropped)", captureStats.framesWritten, captureStats.framesDropped);
+            if (ImGui::Button("Screenshot"))
+                frameCapture.RequestScreenshot(std::format("screenshots/screenshot-{}-{}.png", seed, screenshotCount++));
+            ImGui::SameLine();
+            if (frameCapture.IsRecording() ? ImGui::Button("Stop recording") : ImGui::Button("Record"))
+            {
+                if (frameCapture.IsRecording())
+                    frameCapture.StopRecording();
+                else
+                    frameCapture.StartRecording(std::format("captures/capture-{}.rgba", seed));
+            }
+
+            ImGui::SeparatorText("Input");
+            const auto &inputLatency = actions.GetLatencyStats();
+            ImGui::Text("Input to action: %.2f ms (avg %.2f, max %.2f)", static_cast<double>(inputLatency.lastMilliseconds),
+                        static_cast<double>(inputLatency.averageMilliseconds), static_cast<double>(inputLatency.maxMilliseconds));
+            ImGui::Text("Dropped input events: %u", inputLatency.droppedEvents);
 
             ImGui::SeparatorText("Shader reload");
+            ImGui::Text("Hot reloads: %d", hotReloads);
 
             if (ImGui::Button("Reload base shader"))
             {
                 shader.ReloadShader();
+                shaderVariants.Invalidate("base", ShaderVariantCache::ReadSources(shadersRoot, "base"));
+                renderQueue.ResetShaderCache();
                 std::cout << "Shader reloaded\n";
             }
 
+            ImGui::SeparatorText("Shader variants");
+            ImGui::Checkbox("Use base shader variants", &enableShaderVariants);
+            const auto &variantStats = shaderVariants.GetStats();
+            ImGui::Text("Variants: %d compiled, %d from the binary cache (%.1f ms)", variantStats.compiled, variantStats.loadedFromCache,
+                        static_cast<double>(variantStats.milliseconds));
+
+            ImGui::SeparatorText("Mesh optimisation");
+            if (meshReportTask.valid() && meshReportTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+                meshReports = meshReportTask.get();
+
+            if (meshReportTask.valid())
+                ImGui::Text("Analyzing models...");
+            else if (ImGui::Button("Analyze models"))
+            {
+                // Importing the big models takes a while, keep it out of the frame
+                meshReportTask = std::async(std::launch::async, []() -> std::vector<MeshOptimizer::MeshReport>
+                                            {
+                                                std::vector<MeshOptimizer::MeshReport> reports;
+                                                for (const auto &[gameModel, model] : gameModels)
+                                                {
+                                                    reports.push_back(MeshOptimizer::AnalyzeModel(modelsRoot + model));
+                                                    const auto &[name, before, after] = reports.back();
+                                                    std::cout << std::format("{}: ACMR {:.3f} -> {:.3f}, {} -> {} vertices, {} -> {} KB\n", name,
+                                                                             before.acmr, after.acmr, before.vertices, after.vertices,
+                                                                             before.vertexBytes / 1024, after.vertexBytes / 1024);
+                                                }
+                                                return reports;
+                                            });
+            }
+
+            for (const auto &[name, before, after] : meshReports)
+            {
+                ImGui::Text("%s", name.substr(modelsRoot.size()).c_str());
+                ImGui::Text("  ACMR %.3f -> %.3f | %zu -> %zu KB", static_cast<double>(before.acmr), static_cast<double>(after.acmr),
+                            before.vertexBytes / 1024, after.vertexBytes / 1024);
+            }
+
             ImGui::SeparatorText("Other settings");
             ImGui::Checkbox("Show polygon lines", &polygonMode);
 
@@ -1276,6 +2468,10 @@ int main()
             ImGui::End();
 
             ImGui::Begin("Lights control");
+            ImGui::Text("Point lights in view: %zu / %zu", clusteredLights.GetActiveLights(), pointLights.Size());
+            ImGui::Text("Cluster light assignments: %zu", clusteredLights.GetAssignedIndices());
+            ImGui::Text("Light buffer uploads: %zu bytes in %zu writes", pointLights.ConsumeUploadedBytes() + directionalLights.ConsumeUploadedBytes(),
+                        pointLights.ConsumeFlushes() + directionalLights.ConsumeFlushes());
 
             if (ImGui::Button("Add point light"))
             {
@@ -1296,19 +2492,19 @@ int main()
                 Lights::PointLight &pLight = pointLights[i];
                 ImGui::PushID(std::format("PL{}", i).c_str());
                 ImGui::Columns(3, "Position");
-                ImGui::DragFloat("X", &pLight.position.x);
+                bool changed = ImGui::DragFloat("X", &pLight.position.x);
                 ImGui::NextColumn();
-                ImGui::DragFloat("Y", &pLight.position.y);
+                changed |= ImGui::DragFloat("Y", &pLight.position.y);
                 ImGui::NextColumn();
-                ImGui::DragFloat("Z", &pLight.position.z);
+                changed |= ImGui::DragFloat("Z", &pLight.position.z);
                 ImGui::Columns(1);
                 ImGui::SeparatorText(std::format("Pointlight {}", i).c_str());
-                ImGui::SliderFloat("Constant", &pLight.constant, 0.0, 1.0);
-                ImGui::SliderFloat("Linear", &pLight.linear, 0.0, 1.0);
-                ImGui::SliderFloat("Quadratic", &pLight.quadratic, 0.0, 1.0);
-                ImGui::Checkbox("Is turned on", reinterpret_cast<bool *>(&pLight.isTurnedOn));
-                ImGui::ColorEdit3("Color", reinterpret_cast<float *>(&pLight.diffuse), ImGuiColorEditFlags_Float);
-                pointLights.UpdateIndex(i);
+                changed |= ImGui::SliderFloat("Constant", &pLight.constant, 0.0, 1.0);
+                changed |= ImGui::SliderFloat("Linear", &pLight.linear, 0.0, 1.0);
+                changed |= ImGui::SliderFloat("Quadratic", &pLight.quadratic, 0.0, 1.0);
+                changed |= ImGui::Checkbox("Is turned on", reinterpret_cast<bool *>(&pLight.isTurnedOn));
+                changed |= ImGui::ColorEdit3("Color", reinterpret_cast<float *>(&pLight.diffuse), ImGuiColorEditFlags_Float);
+                if (changed) pointLights.UpdateIndex(i);
 
                 if (ImGui::Button(std::format("Delete", i).c_str()))
                     pointLights.Remove(i);
@@ -1333,18 +2529,18 @@ int main()
                 Lights::DirectionalLight &dLight = directionalLights[i];
                 ImGui::PushID(std::format("DL{}", i).c_str());
                 ImGui::Columns(3, "Direction");
-                ImGui::DragFloat("X", &dLight.direction.x, 0.01f);
+                bool changed = ImGui::DragFloat("X", &dLight.direction.x, 0.01f);
                 ImGui::NextColumn();
-                ImGui::DragFloat("Y", &dLight.direction.y, 0.01f);
+                changed |= ImGui::DragFloat("Y", &dLight.direction.y, 0.01f);
                 ImGui::NextColumn();
-                ImGui::DragFloat("Z", &dLight.direction.z, 0.01f);
+                changed |= ImGui::DragFloat("Z", &dLight.direction.z, 0.01f);
                 ImGui::Columns(1);
-                dLight.direction = glm::normalize(dLight.direction);
+                if (changed) dLight.direction = glm::normalize(dLight.direction);
                 ImGui::SeparatorText(std::format("Directional Light {}", i).c_str());
-                ImGui::ColorEdit3("Ambient", reinterpret_cast<float *>(&dLight.ambient), ImGuiColorEditFlags_Float);
-                ImGui::ColorEdit3("Diffuse", reinterpret_cast<float *>(&dLight.diffuse), ImGuiColorEditFlags_Float);
-                ImGui::ColorEdit3("Specular", reinterpret_cast<float *>(&dLight.specular), ImGuiColorEditFlags_Float);
-                directionalLights.UpdateIndex(i);
+                changed |= ImGui::ColorEdit3("Ambient", reinterpret_cast<float *>(&dLight.ambient), ImGuiColorEditFlags_Float);
+                changed |= ImGui::ColorEdit3("Diffuse", reinterpret_cast<float *>(&dLight.diffuse), ImGuiColorEditFlags_Float);
+                changed |= ImGui::ColorEdit3("Specular", reinterpret_cast<float *>(&dLight.specular), ImGuiColorEditFlags_Float);
+                if (changed) directionalLights.UpdateIndex(i);
 
                 if (ImGui::Button(std::format("Delete", i).c_str()))
                     directionalLights.Remove(i);
@@ -1356,18 +2552,34 @@ int main()
         }
         // endregion
 
-        // region Special keys handle
-        if (!keyboard.GetKeyPress(GLFW_KEY_T)) enableCursorEvent = false;
-        if (!keyboard.GetKeyPress(GLFW_KEY_F11)) fullscreenEvent = false;
-        if (!keyboard.GetKeyPress(GLFW_KEY_F3)) debugMode.event = false;
-        if (!keyboard.GetKeyPress(GLFW_KEY_P)) cameraChange.event = false;
-        // endregion
-
         window.EndGui();
+        profiler.End();
+        MemoryTracker::SetCurrentTag(MemoryTag::General);
+        frameTimer.End();
         window.EndRenderPass();
+        frameArena.Reset();
+        frameAllocations = AllocationCounter::GetCount() - allocationsAtFrameStart;
+        MemoryTracker::EndFrame();
+
+        if (frameTimer.HasResult())
+            profiler.Record("gpu", frameTimer.GetMilliseconds());
+        profiler.EndFrame();
+        benchmark.EndFrame(profiler);
     }
 
     SaveSettings();
+    if constexpr (MemoryTracker::Enabled)
+        MemoryTracker::WriteReport("memory_report.json");
+
+    if (replay.GetMode() == Replay::Mode::Recording)
+        replay.Save();
+    else if (replaying)
+    {
+        const FrameTimeSummary summary = replay.Summarize();
+        std::cout << std::format("Replay {}: {} frames, p50 {:.2f} ms, p95 {:.2f} ms, p99 {:.2f} ms, worst {:.2f} ms\n",
+                                 options.replayPath, summary.frames, summary.p50, summary.p95, summary.p99, summary.worst);
+        std::cout << std::format("Final state hash: {:016x}\n", HashGameState());
+    }
 
     return 0;
 }
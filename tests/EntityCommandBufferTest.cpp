@@ -0,0 +1,105 @@
+#include "../src/Services/EntityCommandBuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace
+{
+constexpr std::uint32_t ThreadCount = 8;
+// Two commands per entity, enough for several chunks of 256
+constexpr std::uint32_t EntitiesPerThread = 300;
+constexpr std::uint32_t Rounds = 2;
+
+struct Recorded
+{
+    std::uint32_t round = 0;
+    std::uint32_t thread = 0;
+    std::uint32_t index = 0;
+    ECS::Entity placeholder = 0;
+};
+
+/// Added in a second command to the same placeholder, must land on the same entity as Recorded.
+struct Mirror
+{
+    ECS::Entity placeholder = 0;
+};
+
+int Fail(const char *message)
+{
+    std::cerr << "\033[31m" << message << "\033[0m\n";
+    return 1;
+}
+} // namespace
+
+/// Commands recorded from many threads at once, across chunk boundaries, are all applied to the right entities.
+int main()
+{
+    ECS::Registry registry;
+    registry.RegisterComponent<Recorded>();
+    registry.RegisterComponent<Mirror>();
+    EntityCommandBuffer commands;
+
+    // The second round records into the chunks the first playback recycled
+    for (std::uint32_t round = 0; round < Rounds; round++)
+    {
+        std::array<std::vector<ECS::Entity>, ThreadCount> placeholders;
+        std::atomic<bool> start = false;
+        std::vector<std::thread> threads;
+        for (std::uint32_t thread = 0; thread < ThreadCount; thread++)
+            threads.emplace_back(
+                [&, thread]()
+                {
+                    while (!start.load(std::memory_order_acquire))
+                        std::this_thread::yield();
+                    for (std::uint32_t index = 0; index < EntitiesPerThread; index++)
+                    {
+                        const ECS::Entity placeholder = commands.Create();
+                        commands.Add(placeholder, Recorded{round, thread, index, placeholder}).Add(placeholder, Mirror{placeholder});
+                        placeholders[thread].push_back(placeholder);
+                    }
+                });
+        start.store(true, std::memory_order_release);
+        for (std::thread &thread : threads)
+            thread.join();
+
+        std::set<ECS::Entity> uniquePlaceholders;
+        for (const auto &recorded : placeholders)
+            uniquePlaceholders.insert(recorded.begin(), recorded.end());
+        if (uniquePlaceholders.size() != ThreadCount * EntitiesPerThread) return Fail("Two threads got the same placeholder.");
+
+        commands.ResetStats();
+        commands.Playback(registry);
+        const EntityCommandStats &stats = commands.GetStats();
+        if (stats.commands != ThreadCount * EntitiesPerThread * 3) return Fail("Recorded commands were lost or repeated.");
+        if (stats.created != ThreadCount * EntitiesPerThread) return Fail("Created entities do not match the Create commands.");
+        if (stats.destroyed != 0 || stats.skipped != 0) return Fail("Commands were skipped without any destroy.");
+        if (!commands.IsEmpty()) return Fail("Playback left commands behind.");
+
+        std::set<ECS::Entity> entities;
+        std::set<ECS::Entity> resolvedPlaceholders;
+        std::vector<std::uint32_t> perThread(ThreadCount, 0);
+        for (const ECS::Entity entity : registry.View<Recorded>())
+        {
+            const auto &recorded = registry.GetComponent<Recorded>(entity);
+            if (recorded.round != round) continue;
+            if (!registry.HasComponent<Mirror>(entity) || registry.GetComponent<Mirror>(entity).placeholder != recorded.placeholder)
+                return Fail("The commands of one placeholder went to different entities.");
+            if (recorded.thread >= ThreadCount || placeholders[recorded.thread][recorded.index] != recorded.placeholder)
+                return Fail("An entity got the component recorded for another placeholder.");
+            entities.insert(entity);
+            resolvedPlaceholders.insert(recorded.placeholder);
+            perThread[recorded.thread]++;
+        }
+        if (entities.size() != ThreadCount * EntitiesPerThread || resolvedPlaceholders != uniquePlaceholders)
+            return Fail("Not every placeholder became its own entity.");
+        if (std::ranges::any_of(perThread, [](const std::uint32_t count) { return count != EntitiesPerThread; }))
+            return Fail("The commands of a thread were lost.");
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+#include "../src/Services/FileWatcher.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+/// A change under a root registered with a trailing separator, like "./shaders/", reaches the main thread.
+int main()
+{
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "FileWatcherTest";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "nested");
+
+    bool applied = false;
+    FileWatcher fileWatcher;
+    fileWatcher.Add(root.string() + "/", [&applied](const std::filesystem::path &path) -> FileWatcher::ApplyFunction
+                    {
+                        if (path.filename() != "changed.txt") return nullptr;
+                        return [&applied]() -> void { applied = true; };
+                    });
+    fileWatcher.Start();
+
+    std::ofstream(root / "nested" / "changed.txt") << "changed";
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (!applied && std::chrono::steady_clock::now() < deadline)
+    {
+        fileWatcher.ApplyPending();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    fileWatcher.Stop();
+    std::filesystem::remove_all(root);
+
+    if (!applied)
+    {
+        std::cerr << "\033[31mThe change under the slash-terminated root was not dispatched.\033[0m\n";
+        return 1;
+    }
+    return 0;
+}